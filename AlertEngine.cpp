@@ -0,0 +1,419 @@
+#include <algorithm>
+#include <limits>
+
+#include "AlertEngine.hpp"
+
+namespace sv
+{
+
+namespace
+{
+
+const double nan = std::numeric_limits<double>::quiet_NaN();
+
+QStringList tokenize(const QString& expression)
+{
+    QStringList tokens;
+    int i = 0;
+    while (i < expression.size())
+    {
+        const QChar c = expression[i];
+        if (c.isSpace())
+        {
+            ++i;
+            continue;
+        }
+
+        int end = i + 1;
+        const bool negative = c == '-' && end < expression.size()
+                              && (expression[end].isDigit() || expression[end] == '.');
+        if (c.isDigit() || c == '.' || negative)
+        {
+            while (end < expression.size() && (expression[end].isDigit() || expression[end] == '.'))
+                ++end;
+        }
+        else if (c.isLetter())
+        {
+            while (end < expression.size() && expression[end].isLetterOrNumber())
+                ++end;
+        }
+        else if ((c == '<' || c == '>') && end < expression.size() && expression[end] == '=')
+        {
+            ++end;
+        }
+
+        tokens << expression.mid(i, end - i).toLower();
+        i = end;
+    }
+    return tokens;
+}
+
+}
+
+bool AlertEngine::compile(const QString& expression, QVector<ConditionSpec>& plan, QString& error)
+{
+    const QStringList tokens = tokenize(expression);
+    int position = 0;
+
+    auto peek = [&tokens, &position]() { return position < tokens.size() ? tokens[position] : QString(); };
+    auto fail = [&error, &peek](const QString& expected)
+    {
+        const QString found = peek();
+        error = QString("Expected %1 but found %2").arg(expected, found.isEmpty() ? "end of rule" : "'" + found + "'");
+        return false;
+    };
+
+    auto parseOperand = [&](OperandSpec& operand)
+    {
+        static const QHash<QString, Operand> columns = {
+            {"open", Operand::Open}, {"high", Operand::High}, {"low", Operand::Low},
+            {"close", Operand::Close}, {"price", Operand::Close}, {"volume", Operand::Volume}
+        };
+        static const QHash<QString, Operand> indicators = {
+            {"sma", Operand::Sma}, {"ema", Operand::Ema}, {"rsi", Operand::Rsi}, {"change", Operand::Change}
+        };
+
+        const QString token = peek();
+        bool isNumber = false;
+        const double number = token.toDouble(&isNumber);
+        if (isNumber)
+        {
+            operand = OperandSpec{ Operand::Constant, number };
+            ++position;
+            return true;
+        }
+        if (columns.contains(token))
+        {
+            operand = OperandSpec{ columns.value(token), 0 };
+            ++position;
+            return true;
+        }
+        if (!indicators.contains(token))
+            return fail("a number, column or indicator");
+
+        ++position;
+        if (peek() != "(")
+            return fail("'('");
+        ++position;
+
+        const int period = peek().toInt(&isNumber);
+        if (!isNumber || period <= 0)
+            return fail("a positive period");
+        ++position;
+
+        if (peek() != ")")
+            return fail("')'");
+        ++position;
+
+        operand = OperandSpec{ indicators.value(token), double(period) };
+        return true;
+    };
+
+    auto parseComparison = [&](Comparison& comparison)
+    {
+        static const QHash<QString, Comparison> symbols = {
+            {"<", Comparison::Less}, {"<=", Comparison::LessEqual},
+            {">", Comparison::Greater}, {">=", Comparison::GreaterEqual}
+        };
+
+        const QString token = peek();
+        if (symbols.contains(token))
+        {
+            comparison = symbols.value(token);
+            ++position;
+            return true;
+        }
+        if (token != "crosses")
+            return fail("a comparison");
+
+        ++position;
+        if (peek() == "above")
+            comparison = Comparison::CrossesAbove;
+        else if (peek() == "below")
+            comparison = Comparison::CrossesBelow;
+        else
+            return fail("'above' or 'below'");
+        ++position;
+        return true;
+    };
+
+    plan.clear();
+    for (;;)
+    {
+        ConditionSpec condition;
+        if (!parseOperand(condition.left) || !parseComparison(condition.comparison) || !parseOperand(condition.right))
+            return false;
+        plan.append(condition);
+
+        if (peek() != "and")
+            break;
+        ++position;
+    }
+
+    if (position != tokens.size())
+        return fail("'and'");
+    return true;
+}
+
+int AlertEngine::addRule(const QString& symbol, const QString& expression, QString* error)
+{
+    Rule rule;
+    rule.symbol = symbol.trimmed().toUpper();
+    rule.expression = expression.simplified();
+
+    QString reason;
+    if (!compile(rule.expression, rule.plan, reason))
+    {
+        if (error != nullptr)
+            *error = reason;
+        return -1;
+    }
+
+    const int ruleId = rules.size();
+    rules.append(rule);
+    ++activeRules;
+
+    for (auto it = states.begin(); it != states.end(); ++it)
+    {
+        if (rule.symbol.isEmpty() || rule.symbol == it.key())
+            bind(it.value(), ruleId);
+    }
+    return ruleId;
+}
+
+void AlertEngine::removeRule(int ruleId)
+{
+    // Bindings of inactive rules are skipped during evaluation
+    if (ruleId >= 0 && ruleId < rules.size() && rules[ruleId].active)
+    {
+        rules[ruleId].active = false;
+        --activeRules;
+    }
+}
+
+void AlertEngine::clear()
+{
+    rules.clear();
+    states.clear();
+    activeRules = 0;
+}
+
+QVector<AlertHit> AlertEngine::update(const Series& series)
+{
+    QVector<AlertHit> hits;
+    if (series.isEmpty())
+        return hits;
+
+    SymbolState& state = stateFor(series.getSymbol());
+
+    // Bars present the first time a symbol is seen are history, not news
+    if (state.lastTime < 0 && state.reportedTime < 0)
+        state.reportedTime = series.lastTime();
+
+    const double* time = series.column(Series::Time);
+    const int first = static_cast<int>(std::upper_bound(time, time + series.size(), state.lastTime) - time);
+    for (int i = first; i < series.size(); ++i)
+        evaluate(series.getSymbol(), state, series.bar(i), hits);
+
+    return hits;
+}
+
+QVector<AlertHit> AlertEngine::append(const QString& symbol, const Bar& bar)
+{
+    QVector<AlertHit> hits;
+    SymbolState& state = stateFor(symbol);
+    if (bar.time > state.lastTime)
+        evaluate(symbol, state, bar, hits);
+    return hits;
+}
+
+AlertEngine::SymbolState& AlertEngine::stateFor(const QString& symbol)
+{
+    auto it = states.find(symbol);
+    if (it != states.end())
+        return it.value();
+
+    it = states.insert(symbol, SymbolState());
+    for (int ruleId = 0; ruleId < rules.size(); ++ruleId)
+    {
+        const Rule& rule = rules[ruleId];
+        if (rule.active && (rule.symbol.isEmpty() || rule.symbol == symbol))
+            bind(it.value(), ruleId);
+    }
+    return it.value();
+}
+
+void AlertEngine::bind(SymbolState& state, int ruleId)
+{
+    const int sourceCount = state.sources.size();
+
+    Binding binding;
+    binding.ruleId = ruleId;
+    binding.firstCondition = state.conditions.size();
+    binding.conditionCount = rules[ruleId].plan.size();
+
+    for (const ConditionSpec& spec : rules[ruleId].plan)
+        state.conditions.append(Condition{ sourceFor(state, spec.left), spec.comparison, sourceFor(state, spec.right) });
+
+    // A new indicator has no history yet; replay the symbol on its next update
+    // without reporting bars that were already evaluated
+    if (state.lastTime >= 0 && state.sources.size() != sourceCount)
+    {
+        state.reportedTime = std::max(state.reportedTime, state.lastTime);
+        resetIndicators(state);
+    }
+
+    binding.wasTrue = isTrue(state, binding);
+    state.bindings.append(binding);
+}
+
+int AlertEngine::sourceFor(SymbolState& state, const OperandSpec& operand)
+{
+    const QString key = QString("%1:%2").arg(static_cast<int>(operand.kind)).arg(operand.argument);
+    const auto found = state.sourceIndex.constFind(key);
+    if (found != state.sourceIndex.constEnd())
+        return found.value();
+
+    Source source{ operand.kind, -1, nan };
+    const int period = static_cast<int>(operand.argument);
+    switch (operand.kind)
+    {
+    case Operand::Constant:
+        source.constant = operand.argument;
+        break;
+    case Operand::Sma:
+        source.index = static_cast<int>(state.sma.size());
+        state.sma.emplace_back(period);
+        break;
+    case Operand::Ema:
+        source.index = static_cast<int>(state.ema.size());
+        state.ema.emplace_back(period);
+        break;
+    case Operand::Rsi:
+        source.index = static_cast<int>(state.rsi.size());
+        state.rsi.emplace_back(period);
+        break;
+    case Operand::Change:
+        source.index = static_cast<int>(state.change.size());
+        state.change.emplace_back(period);
+        break;
+    default:
+        break;
+    }
+
+    const int index = state.sources.size();
+    state.sources.append(source);
+    state.values.append(source.constant);
+    state.previous.append(source.constant);
+    state.sourceIndex.insert(key, index);
+    return index;
+}
+
+void AlertEngine::resetIndicators(SymbolState& state)
+{
+    for (SimpleMovingAverage& indicator : state.sma)
+        indicator.reset();
+    for (ExponentialMovingAverage& indicator : state.ema)
+        indicator.reset();
+    for (RelativeStrengthIndex& indicator : state.rsi)
+        indicator.reset();
+    for (PercentChange& indicator : state.change)
+        indicator.reset();
+
+    for (int i = 0; i < state.sources.size(); ++i)
+        state.values[i] = state.previous[i] = state.sources[i].constant;
+    for (Binding& binding : state.bindings)
+        binding.wasTrue = false;
+
+    state.lastTime = -1;
+}
+
+bool AlertEngine::isTrue(const SymbolState& state, const Binding& binding)
+{
+    const double* values = state.values.constData();
+    const double* previous = state.previous.constData();
+
+    // NaN operands (indicators still warming up) make every comparison false
+    for (int i = binding.firstCondition; i < binding.firstCondition + binding.conditionCount; ++i)
+    {
+        const Condition& condition = state.conditions[i];
+        const double left = values[condition.left];
+        const double right = values[condition.right];
+
+        bool holds = false;
+        switch (condition.comparison)
+        {
+        case Comparison::Less:
+            holds = left < right;
+            break;
+        case Comparison::LessEqual:
+            holds = left <= right;
+            break;
+        case Comparison::Greater:
+            holds = left > right;
+            break;
+        case Comparison::GreaterEqual:
+            holds = left >= right;
+            break;
+        case Comparison::CrossesAbove:
+            holds = previous[condition.left] <= previous[condition.right] && left > right;
+            break;
+        case Comparison::CrossesBelow:
+            holds = previous[condition.left] >= previous[condition.right] && left < right;
+            break;
+        }
+
+        if (!holds)
+            return false;
+    }
+    return true;
+}
+
+void AlertEngine::evaluate(const QString& symbol, SymbolState& state, const Bar& bar, QVector<AlertHit>& hits)
+{
+    // Each distinct indicator is updated once, however many rules use it
+    for (SimpleMovingAverage& indicator : state.sma)
+        indicator.push(bar.close);
+    for (ExponentialMovingAverage& indicator : state.ema)
+        indicator.push(bar.close);
+    for (RelativeStrengthIndex& indicator : state.rsi)
+        indicator.push(bar.close);
+    for (PercentChange& indicator : state.change)
+        indicator.push(bar.close);
+
+    std::swap(state.values, state.previous);
+    for (int i = 0; i < state.sources.size(); ++i)
+    {
+        const Source& source = state.sources[i];
+        double& value = state.values[i];
+        switch (source.kind)
+        {
+        case Operand::Constant: value = source.constant; break;
+        case Operand::Open: value = bar.open; break;
+        case Operand::High: value = bar.high; break;
+        case Operand::Low: value = bar.low; break;
+        case Operand::Close: value = bar.close; break;
+        case Operand::Volume: value = bar.volume; break;
+        case Operand::Sma: value = state.sma[source.index].value(); break;
+        case Operand::Ema: value = state.ema[source.index].value(); break;
+        case Operand::Rsi: value = state.rsi[source.index].value(); break;
+        case Operand::Change: value = state.change[source.index].value() * 100; break;
+        }
+    }
+
+    const bool report = bar.time > state.reportedTime;
+    for (Binding& binding : state.bindings)
+    {
+        if (!rules[binding.ruleId].active)
+            continue;
+
+        const bool holds = isTrue(state, binding);
+        if (holds && !binding.wasTrue && report)
+            hits.append(AlertHit{ binding.ruleId, symbol, bar.time, rules[binding.ruleId].expression });
+        binding.wasTrue = holds;
+    }
+
+    state.lastTime = bar.time;
+}
+
+}
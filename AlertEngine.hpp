@@ -0,0 +1,165 @@
+#ifndef ALERTENGINE_HPP
+#define ALERTENGINE_HPP
+
+#include <vector>
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "Indicators.hpp"
+#include "Series.hpp"
+
+namespace sv
+{
+
+struct AlertHit
+{
+    int ruleId;
+    QString symbol;
+    double time;
+    QString expression;
+};
+
+/**
+ * @brief Price and indicator alerts evaluated incrementally on each new bar.
+ *
+ * Rules are written as comparisons joined by "and", for example
+ *
+ *     close crosses above sma(50)
+ *     rsi(14) > 70
+ *     change(5) <= -8 and volume > 1000000
+ *
+ * Operands are numbers, the bar columns (open, high, low, close, volume) and
+ * the indicators sma(n), ema(n), rsi(n) and change(n), the percent change of
+ * the close over n bars. Comparisons are <, <=, >, >=, "crosses above" and
+ * "crosses below".
+ *
+ * A rule is compiled once into a plan of operand specs. Binding it to a
+ * symbol resolves the operands to sources in that symbol's indicator state,
+ * shared by every rule using the same indicator, so a new bar updates each
+ * distinct indicator once and then costs O(1) per rule. A rule fires when it
+ * becomes true, not on every bar it stays true.
+ */
+class AlertEngine
+{
+public:
+    /**
+     * @brief Compile and register a rule.
+     * @param symbol The symbol it applies to; empty applies it to every symbol.
+     * @return The rule id, or -1 with the reason in `error` if it does not parse.
+     */
+    int addRule(const QString& symbol, const QString& expression, QString* error = nullptr);
+
+    void removeRule(int ruleId);
+
+    void clear();
+
+    int ruleCount() const
+    {
+        return activeRules;
+    }
+
+    /**
+     * @brief Evaluate the bars of `series` newer than the last update for its
+     *        symbol. The first update of a symbol, or the first after a rule
+     *        was added, only warms the indicators and reports nothing for
+     *        bars that were already seen.
+     */
+    QVector<AlertHit> update(const Series& series);
+
+    // Evaluate a single new bar for the symbol
+    QVector<AlertHit> append(const QString& symbol, const Bar& bar);
+
+    // Forget the bars seen for the symbol; its next update only warms the indicators again
+    void resetSymbol(const QString& symbol)
+    {
+        states.remove(symbol);
+    }
+
+private:
+    enum class Operand { Constant, Open, High, Low, Close, Volume, Sma, Ema, Rsi, Change };
+    enum class Comparison { Less, LessEqual, Greater, GreaterEqual, CrossesAbove, CrossesBelow };
+
+    struct OperandSpec
+    {
+        Operand kind;
+        double argument;             // constant value or indicator period
+    };
+
+    struct ConditionSpec
+    {
+        OperandSpec left;
+        Comparison comparison;
+        OperandSpec right;
+    };
+
+    struct Rule
+    {
+        QString symbol;
+        QString expression;
+        QVector<ConditionSpec> plan;
+        bool active = true;
+    };
+
+    // A condition with its operands resolved to sources of one symbol's state
+    struct Condition
+    {
+        int left;
+        Comparison comparison;
+        int right;
+    };
+
+    struct Binding
+    {
+        int ruleId;
+        int firstCondition;
+        int conditionCount;
+        bool wasTrue = false;
+    };
+
+    // Where an operand value comes from: a bar column, a constant or an indicator instance
+    struct Source
+    {
+        Operand kind;
+        int index;                   // into the indicator vector of that kind
+        double constant;
+    };
+
+    struct SymbolState
+    {
+        QVector<Source> sources;
+        QHash<QString, int> sourceIndex;
+        QVector<double> values;
+        QVector<double> previous;
+
+        std::vector<SimpleMovingAverage> sma;
+        std::vector<ExponentialMovingAverage> ema;
+        std::vector<RelativeStrengthIndex> rsi;
+        std::vector<PercentChange> change;
+
+        QVector<Condition> conditions;
+        QVector<Binding> bindings;
+
+        double lastTime = -1;        // newest bar applied
+        double reportedTime = -1;    // hits are only reported for bars after this
+    };
+
+    static bool compile(const QString& expression, QVector<ConditionSpec>& plan, QString& error);
+
+    void bind(SymbolState& state, int ruleId);
+    int sourceFor(SymbolState& state, const OperandSpec& operand);
+    static bool isTrue(const SymbolState& state, const Binding& binding);
+    SymbolState& stateFor(const QString& symbol);
+    void resetIndicators(SymbolState& state);
+    void evaluate(const QString& symbol, SymbolState& state, const Bar& bar, QVector<AlertHit>& hits);
+
+    QVector<Rule> rules;
+    QHash<QString, SymbolState> states;
+    int activeRules = 0;
+};
+
+}
+
+#endif // ALERTENGINE_HPP
@@ -0,0 +1,143 @@
+#include <algorithm>
+
+#include <QCryptographicHash>
+#include <QFile>
+
+#include "AnalysisCache.hpp"
+
+namespace sv
+{
+
+AnalysisCache::AnalysisCache(int capacity)
+    : capacity(capacity > 0 ? capacity : 1)
+{
+}
+
+QByteArray AnalysisCache::fileDigest(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file))
+        return QByteArray();
+    return hash.result();
+}
+
+QByteArray AnalysisCache::jobKey(const QByteArray& scriptDigest, const QStringList& arguments)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(scriptDigest);
+
+    // Length-prefixed so that ("a b") and ("a", "b") differ
+    for (const QString& argument : arguments)
+    {
+        const QByteArray bytes = argument.toUtf8();
+        const qint32 length = bytes.size();
+        hash.addData(reinterpret_cast<const char*>(&length), sizeof(length));
+        hash.addData(bytes);
+    }
+    return hash.result();
+}
+
+QByteArray AnalysisCache::fingerprint(const Series* series, int rows)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (series == nullptr)
+        return hash.result();
+
+    rows = rows < 0 ? series->size() : std::min(rows, series->size());
+    hash.addData(series->getSymbol().toUtf8());
+    hash.addData(reinterpret_cast<const char*>(&rows), sizeof(rows));
+    for (int column = 0; column < Series::ColumnCount; ++column)
+    {
+        hash.addData(reinterpret_cast<const char*>(series->column(static_cast<Series::Column>(column))),
+                     static_cast<int>(rows * sizeof(double)));
+    }
+    return hash.result();
+}
+
+AnalysisCache::Lookup AnalysisCache::find(const QByteArray& job, const SeriesPtr& series)
+{
+    Lookup lookup;
+    const auto it = entries.find(job);
+    if (it == entries.end())
+        return lookup;
+
+    const int rows = series.isNull() ? 0 : series->size();
+    if (it->rows == rows && it->fingerprint == fingerprint(series.data()))
+        lookup.match = Match::Exact;
+    else if (it->rows > 0 && it->rows < rows && it->fingerprint == fingerprint(series.data(), it->rows))
+        lookup.match = Match::Appended;
+    else
+        return lookup;
+
+    it->lastUsed = ++clock;
+    lookup.result = it->result;
+    lookup.cachedRows = it->rows;
+    return lookup;
+}
+
+void AnalysisCache::insert(const QByteArray& job, const SeriesPtr& series, const AnalysisResult& result)
+{
+    // One entry per job: a newer series supersedes the result for the older one
+    if (!entries.contains(job) && entries.size() >= capacity)
+    {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (it->lastUsed < oldest->lastUsed)
+                oldest = it;
+        }
+        entries.erase(oldest);
+    }
+
+    Entry& entry = entries[job];
+    entry.fingerprint = fingerprint(series.data());
+    entry.rows = series.isNull() ? 0 : series->size();
+    entry.result = result;
+    entry.lastUsed = ++clock;
+}
+
+void AnalysisCache::clear()
+{
+    entries.clear();
+}
+
+AnalysisResult AnalysisCache::extend(const AnalysisResult& cached, const AnalysisResult& tail, double cachedUntil)
+{
+    AnalysisResult result = tail;
+
+    // Series are matched by position; anything the tail run did not produce is dropped
+    for (int i = 0; i < result.series.size() && i < cached.series.size(); ++i)
+    {
+        QVector<QPointF> points;
+        for (const QPointF& point : cached.series[i].points)
+        {
+            if (point.x() <= cachedUntil)
+                points.append(point);
+        }
+        for (const QPointF& point : tail.series[i].points)
+        {
+            if (point.x() > cachedUntil)
+                points.append(point);
+        }
+        result.series[i].points = points;
+    }
+
+    result.annotations.clear();
+    for (const Annotation& annotation : cached.annotations)
+    {
+        if (annotation.timestamp <= cachedUntil)
+            result.annotations.append(annotation);
+    }
+    for (const Annotation& annotation : tail.annotations)
+    {
+        if (annotation.timestamp > cachedUntil)
+            result.annotations.append(annotation);
+    }
+    return result;
+}
+
+}
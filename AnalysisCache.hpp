@@ -0,0 +1,91 @@
+#ifndef ANALYSISCACHE_HPP
+#define ANALYSISCACHE_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QStringList>
+
+#include "QtUtils.hpp"
+#include "Series.hpp"
+
+namespace sv
+{
+
+/**
+ * @brief Memoized analysis results.
+ *
+ * A job is identified by a content hash of the script or plugin file plus its
+ * arguments, and each job remembers the result of its latest run together with
+ * a fingerprint of the series it ran on. Running the same job on the same data
+ * again is a lookup. When the series has only grown at the end since then, the
+ * lookup reports an append so the caller may run the job on the new bars alone
+ * and splice the two results together with extend().
+ */
+class AnalysisCache
+{
+public:
+    enum class Match
+    {
+        None,
+        Exact,                       // same script, arguments and data
+        Appended                     // same script and arguments; the data gained bars at the end
+    };
+
+    struct Lookup
+    {
+        Match match = Match::None;
+        AnalysisResult result;
+        int cachedRows = 0;          // rows of the series the cached result was computed on
+    };
+
+    explicit AnalysisCache(int capacity = 64);
+
+    // Content hash of a script or plugin; empty if the file cannot be read
+    static QByteArray fileDigest(const QString& path);
+
+    static QByteArray jobKey(const QByteArray& scriptDigest, const QStringList& arguments);
+
+    // Hash of the symbol and the first `rows` rows (all rows if negative) of every column
+    static QByteArray fingerprint(const Series* series, int rows = -1);
+
+    Lookup find(const QByteArray& job, const SeriesPtr& series);
+
+    void insert(const QByteArray& job, const SeriesPtr& series, const AnalysisResult& result);
+
+    void clear();
+
+    int size() const
+    {
+        return static_cast<int>(entries.size());
+    }
+
+    /**
+     * @brief Splice a result computed on the bars after `cachedUntil` (plus
+     *        whatever lookback it needed) onto a cached result.
+     *
+     * `cachedUntil` is the time of the last bar the cached result saw. Points
+     * and annotations up to it come from `cached`, the rest from `tail`, so
+     * anything the cached run projected past its last bar (e.g. a forecast)
+     * is replaced. Metrics and output are taken from `tail`, as they describe
+     * the latest bar. Only valid for analyses whose value at a bar depends on
+     * a bounded window of history.
+     */
+    static AnalysisResult extend(const AnalysisResult& cached, const AnalysisResult& tail, double cachedUntil);
+
+private:
+    struct Entry
+    {
+        QByteArray fingerprint;
+        int rows = 0;
+        AnalysisResult result;
+        quint64 lastUsed = 0;
+    };
+
+    int capacity;
+    quint64 clock = 0;
+    QHash<QByteArray, Entry> entries;
+};
+
+}
+
+#endif // ANALYSISCACHE_HPP
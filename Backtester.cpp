@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Backtester.hpp"
+
+namespace sv
+{
+
+SmaCrossStrategy::SmaCrossStrategy(const ParameterSet& parameters)
+    : fast(static_cast<int>(parameters.value("fast", 20))),
+      slow(static_cast<int>(parameters.value("slow", 50)))
+{
+}
+
+double SmaCrossStrategy::onBar(const Bar& bar)
+{
+    fast.push(bar.close);
+    slow.push(bar.close);
+
+    if (!slow.isReady() || !fast.isReady())
+        return 0;
+
+    return fast.value() > slow.value() ? 1 : -1;
+}
+
+RsiStrategy::RsiStrategy(const ParameterSet& parameters)
+    : rsi(static_cast<int>(parameters.value("period", 14))),
+      lower(parameters.value("lower", 30)),
+      upper(parameters.value("upper", 70))
+{
+}
+
+double RsiStrategy::onBar(const Bar& bar)
+{
+    rsi.push(bar.close);
+
+    if (rsi.isReady())
+    {
+        const double value = rsi.value();
+        if (value < lower)
+            exposure = 1;
+        else if (value > upper)
+            exposure = -1;
+    }
+
+    return exposure;
+}
+
+StrategyFactory strategyFactory(const QString& name)
+{
+    if (name == QLatin1String("sma"))
+        return [](const ParameterSet& parameters) { return std::unique_ptr<Strategy>(new SmaCrossStrategy(parameters)); };
+    if (name == QLatin1String("rsi"))
+        return [](const ParameterSet& parameters) { return std::unique_ptr<Strategy>(new RsiStrategy(parameters)); };
+    return StrategyFactory();
+}
+
+BacktestResult Backtester::run(const Series& series, Strategy& strategy, bool recordEquity) const
+{
+    BacktestResult result;
+
+    const int n = series.size();
+    if (n == 0)
+        return result;
+
+    if (recordEquity)
+    {
+        result.time.reserve(n);
+        result.equity.reserve(n);
+    }
+
+    const double* open = series.column(Series::Open);
+    const double* close = series.column(Series::Close);
+    const double* time = series.column(Series::Time);
+    const double minimumExposure = config.allowShort ? -1 : 0;
+
+    double cash = config.initialCash;
+    double position = 0;
+    double currentExposure = 0;
+    double pendingExposure = 0;
+    bool hasPendingOrder = false;
+
+    // Running statistics so sweeps do not need the equity curve
+    double peak = config.initialCash;
+    double previousEquity = config.initialCash;
+    double returnMean = 0;
+    double returnM2 = 0;
+    int returnCount = 0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        // Fill the order decided at the previous close at this bar's open
+        if (hasPendingOrder)
+        {
+            const double price = open[i] > 0 ? open[i] : close[i];
+            const double equityAtOpen = cash + position * price;
+            const double targetShares = std::trunc(pendingExposure * equityAtOpen / price);
+            const double quantity = targetShares - position;
+
+            if (quantity != 0)
+            {
+                const double direction = quantity > 0 ? 1 : -1;
+                const double fillPrice = price * (1 + direction * config.slippageBps / 10000);
+                const double commission = config.commissionPerTrade + config.commissionRate * std::abs(quantity) * fillPrice;
+
+                cash -= quantity * fillPrice + commission;
+                position += quantity;
+                ++result.metrics.tradeCount;
+
+                if (recordEquity)
+                    result.trades.append(Trade{ time[i], quantity, fillPrice, commission });
+            }
+
+            currentExposure = pendingExposure;
+            hasPendingOrder = false;
+        }
+
+        const double equity = cash + position * close[i];
+
+        peak = std::max(peak, equity);
+        if (peak > 0)
+            result.metrics.maxDrawdown = std::max(result.metrics.maxDrawdown, 1 - equity / peak);
+
+        if (previousEquity != 0)
+        {
+            const double periodReturn = equity / previousEquity - 1;
+            ++returnCount;
+            const double delta = periodReturn - returnMean;
+            returnMean += delta / returnCount;
+            returnM2 += delta * (periodReturn - returnMean);
+        }
+        previousEquity = equity;
+
+        if (recordEquity)
+        {
+            result.time.append(time[i]);
+            result.equity.append(equity);
+        }
+
+        const double exposure = std::clamp(strategy.onBar(series.bar(i)), minimumExposure, 1.0);
+        if (exposure != currentExposure && i + 1 < n)
+        {
+            pendingExposure = exposure;
+            hasPendingOrder = true;
+        }
+    }
+
+    result.metrics.totalReturn = previousEquity / config.initialCash - 1;
+    if (returnCount > 1 && returnM2 > 0)
+        result.metrics.sharpe = returnMean / std::sqrt(returnM2 / (returnCount - 1)) * std::sqrt(252.0);
+
+    return result;
+}
+
+QVector<ParameterSet> ParameterGrid::combinations() const
+{
+    QVector<ParameterSet> result;
+    if (axes.isEmpty())
+        return result;
+
+    const QStringList names = axes.keys();
+    QVector<int> index(names.size(), 0);
+
+    for (const QString& name : names)
+    {
+        if (axes[name].isEmpty())
+            return result;
+    }
+
+    for (;;)
+    {
+        ParameterSet parameters;
+        for (int i = 0; i < names.size(); ++i)
+            parameters.insert(names[i], axes[names[i]][index[i]]);
+        result.append(parameters);
+
+        // Odometer-style increment over the axes
+        int axis = names.size() - 1;
+        while (axis >= 0 && ++index[axis] == axes[names[axis]].size())
+        {
+            index[axis] = 0;
+            --axis;
+        }
+        if (axis < 0)
+            break;
+    }
+
+    return result;
+}
+
+QVector<ParameterSet> ParameterGrid::sample(int count, quint32 seed) const
+{
+    QVector<ParameterSet> result;
+    std::mt19937 generator(seed);
+
+    for (int i = 0; i < count; ++i)
+    {
+        ParameterSet parameters;
+        for (auto it = axes.cbegin(); it != axes.cend(); ++it)
+        {
+            if (it.value().isEmpty())
+                continue;
+            std::uniform_int_distribution<int> pick(0, it.value().size() - 1);
+            parameters.insert(it.key(), it.value()[pick(generator)]);
+        }
+        result.append(parameters);
+    }
+
+    return result;
+}
+
+QVector<SweepResult> runSweep(const QVector<SeriesPtr>& series, const QVector<ParameterSet>& parameters,
+                              const StrategyFactory& factory, const BacktestConfig& config, int threadCount,
+                              const std::atomic<bool>* cancelled)
+{
+    const int jobCount = series.size() * parameters.size();
+    if (jobCount == 0 || !factory)
+        return QVector<SweepResult>();
+
+    QVector<SweepResult> results(jobCount);
+
+    // Detach once up front; workers then write disjoint slots through a raw pointer
+    SweepResult* output = results.data();
+    const Backtester backtester(config);
+    std::atomic<int> nextJob{0};
+
+    auto worker = [&]()
+    {
+        for (int job = nextJob.fetch_add(1, std::memory_order_relaxed); job < jobCount;
+             job = nextJob.fetch_add(1, std::memory_order_relaxed))
+        {
+            if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed))
+                break;
+
+            const int seriesIndex = job / parameters.size();
+            const int parameterIndex = job % parameters.size();
+
+            std::unique_ptr<Strategy> strategy = factory(parameters[parameterIndex]);
+            const BacktestResult result = backtester.run(*series[seriesIndex], *strategy, false);
+
+            output[job] = SweepResult{ seriesIndex, parameterIndex, result.metrics };
+        }
+    };
+
+    if (threadCount <= 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, jobCount);
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (int i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    return results;
+}
+
+}
@@ -0,0 +1,154 @@
+#ifndef BACKTESTER_HPP
+#define BACKTESTER_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "Indicators.hpp"
+#include "Series.hpp"
+
+namespace sv
+{
+
+using ParameterSet = QMap<QString, double>;
+
+struct BacktestConfig
+{
+    double initialCash = 10000;
+    double commissionPerTrade = 0;   // flat fee per fill
+    double commissionRate = 0;       // fraction of traded notional
+    double slippageBps = 0;          // adverse price move applied to every fill
+    bool allowShort = false;
+};
+
+struct Trade
+{
+    double time;
+    double quantity;                 // signed share count
+    double price;
+    double commission;
+};
+
+struct BacktestMetrics
+{
+    double totalReturn = 0;
+    double maxDrawdown = 0;
+    double sharpe = 0;
+    int tradeCount = 0;
+};
+
+struct BacktestResult
+{
+    QVector<double> time;
+    QVector<double> equity;
+    QVector<Trade> trades;
+    BacktestMetrics metrics;
+};
+
+/**
+ * @brief A trading strategy driven one bar at a time. After each bar closes it
+ *        returns the desired exposure as a fraction of equity, from -1 (fully
+ *        short) to 1 (fully long); the order is filled at the next bar's open.
+ */
+class Strategy
+{
+public:
+    virtual ~Strategy() = default;
+    virtual double onBar(const Bar& bar) = 0;
+};
+
+using StrategyFactory = std::function<std::unique_ptr<Strategy>(const ParameterSet&)>;
+
+// Long while SMA(fast) is above SMA(slow), the trend rule from SimpleAnalysis.py;
+// short otherwise when the backtest allows it
+class SmaCrossStrategy : public Strategy
+{
+public:
+    explicit SmaCrossStrategy(const ParameterSet& parameters);
+    double onBar(const Bar& bar) override;
+
+private:
+    SimpleMovingAverage fast;
+    SimpleMovingAverage slow;
+};
+
+// Buy when RSI drops below `lower`, exit (or go short) when it rises above `upper`
+class RsiStrategy : public Strategy
+{
+public:
+    explicit RsiStrategy(const ParameterSet& parameters);
+    double onBar(const Bar& bar) override;
+
+private:
+    RelativeStrengthIndex rsi;
+    double lower;
+    double upper;
+    double exposure = 0;
+};
+
+/**
+ * @brief Factory for the built-in strategies ("sma", "rsi"); returns an empty
+ *        function for unknown names.
+ */
+StrategyFactory strategyFactory(const QString& name);
+
+class Backtester
+{
+public:
+    explicit Backtester(const BacktestConfig& config = BacktestConfig{})
+        : config(config)
+    {
+    }
+
+    /**
+     * @brief Replay the series through the strategy.
+     * @param recordEquity Keep the equity curve and trade list; sweeps turn this
+     *                     off and only keep the metrics.
+     */
+    BacktestResult run(const Series& series, Strategy& strategy, bool recordEquity = true) const;
+
+private:
+    BacktestConfig config;
+};
+
+// Values to try for every parameter
+struct ParameterGrid
+{
+    QMap<QString, QVector<double>> axes;
+
+    // Every combination of the axis values
+    QVector<ParameterSet> combinations() const;
+
+    // `count` combinations drawn uniformly at random, reproducible for a given seed
+    QVector<ParameterSet> sample(int count, quint32 seed) const;
+};
+
+struct SweepResult
+{
+    int seriesIndex;
+    int parameterIndex;
+    BacktestMetrics metrics;
+};
+
+/**
+ * @brief Backtest every parameter set against every series using all cores.
+ *        Each job builds its own strategy and results land in preallocated
+ *        slots, so workers share nothing but an atomic job counter.
+ * @param threadCount Number of worker threads; 0 uses the hardware concurrency.
+ * @param cancelled Once set, workers take no more jobs and the remaining
+ *                  results are left zeroed.
+ *
+ * @return One result per (series, parameter set), series-major.
+ */
+QVector<SweepResult> runSweep(const QVector<SeriesPtr>& series, const QVector<ParameterSet>& parameters,
+                              const StrategyFactory& factory, const BacktestConfig& config, int threadCount = 0,
+                              const std::atomic<bool>* cancelled = nullptr);
+
+}
+
+#endif // BACKTESTER_HPP
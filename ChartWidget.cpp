@@ -1,9 +1,12 @@
+#include <algorithm>
+
 #include <QPainter>
 #include <QPen>
 #include <QBrush>
 #include <QFontMetrics>
 #include <QDebug>
 #include <QDateTime>
+#include <QWheelEvent>
 #include "ChartWidget.hpp"
 
 ChartWidget::ChartWidget(QWidget *parent) : QWidget(parent)
@@ -29,6 +32,12 @@ void ChartWidget::appendData(const QVector<QPointF>& data)
     update();
 }
 
+void ChartWidget::appendPoints(const QVector<QPointF>& points)
+{
+    rawData += points;
+    update();
+}
+
 void ChartWidget::setData(const QVector<QPointF>& data, const QMap<QString, QString>& labelData)
 {
     rawData = data;
@@ -56,6 +65,70 @@ void ChartWidget::setLegendData(const QString& legendData)
     update();
 }
 
+void ChartWidget::setOverlays(const QVector<sv::StockDataResult>& overlays)
+{
+    this->overlays = overlays;
+    update();
+}
+
+void ChartWidget::setAnnotations(const QVector<sv::Annotation>& annotations)
+{
+    this->annotations = annotations;
+    update();
+}
+
+void ChartWidget::setForecast(const QVector<QPointF>& expected, const QVector<QPointF>& lower,
+                              const QVector<QPointF>& upper)
+{
+    forecastExpected = expected;
+    forecastLower = lower;
+    forecastUpper = upper;
+    update();
+}
+
+void ChartWidget::setXRange(double from, double to)
+{
+    xFrom = from;
+    xTo = to;
+    update();
+}
+
+void ChartWidget::wheelEvent(QWheelEvent* event)
+{
+    if (rawData.size() < 2 || chartSpec.width <= 0)
+        return;
+
+    // Zoom the time axis around the cursor, never beyond the full series
+    const double fullFrom = rawData.first().x();
+    const double fullTo = rawData.last().x();
+    const double from = xFrom < xTo ? xFrom : fullFrom;
+    const double to = xFrom < xTo ? xTo : fullTo;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const double cursorX = event->position().x();
+#else
+    const double cursorX = event->posF().x();
+#endif
+    const double fraction = std::clamp((cursorX - chartSpec.leftMargin) / chartSpec.width, 0.0, 1.0);
+    const double anchor = from + fraction * (to - from);
+    const double factor = event->angleDelta().y() > 0 ? 0.8 : 1.25;
+
+    const double newFrom = std::max(fullFrom, anchor - (anchor - from) * factor);
+    const double newTo = std::min(fullTo, anchor + (to - anchor) * factor);
+    if (newFrom <= fullFrom && newTo >= fullTo)
+        resetZoom();
+    else if (newTo - newFrom > 0)
+        setXRange(newFrom, newTo);
+
+    event->accept();
+}
+
+void ChartWidget::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    Q_UNUSED(event);
+    resetZoom();
+}
+
 void ChartWidget::paintEvent(QPaintEvent* event)
 {
     Q_UNUSED(event);
@@ -67,7 +140,17 @@ void ChartWidget::paintEvent(QPaintEvent* event)
         return;
 
     chartSpec = ChartSpec{(double)this->width(), (double)this->height()};
-    chartSpec.setScale( estimateData.empty() ? rawData : estimateData );
+    // The scale takes its x range from the first and last points, so the band goes at the end
+    QVector<QPointF> scaleData = estimateData.empty() ? rawData : estimateData;
+    if (!forecastUpper.isEmpty() && forecastUpper.last().x() > scaleData.last().x())
+    {
+        scaleData += forecastLower;
+        scaleData += forecastUpper;
+    }
+    if (xFrom < xTo)
+        chartSpec.setScale( scaleData, xFrom, xTo );
+    else
+        chartSpec.setScale( scaleData );
 
     // Draw background
     painter.fillRect(rect(), Qt::white);
@@ -164,9 +247,40 @@ void ChartWidget::paintEvent(QPaintEvent* event)
     // Draw the data line
     if (rawData.size() >= 2)
     {
+        // Zoomed curves extend past the axes; keep them inside the plot area
+        painter.save();
+        painter.setClipRect(QRectF(chartSpec.leftMargin, chartSpec.topMargin, chartSpec.width, chartSpec.height));
+
         QPen chartPen = drawCurve(painter, Qt::red, estimateData, chartSpec);
         drawCurve(painter, Qt::blue, rawData, chartSpec);
 
+        // Additional analysis outputs, cycling through a few distinguishable colors
+        const Qt::GlobalColor overlayColors[] = { Qt::darkGreen, Qt::magenta, Qt::darkCyan, Qt::darkYellow };
+        for (int i = 0; i < overlays.size(); ++i)
+            drawCurve(painter, overlayColors[i % 4], overlays[i].points, chartSpec);
+
+        drawCurve(painter, Qt::gray, forecastLower, chartSpec, Qt::DotLine);
+        drawCurve(painter, Qt::gray, forecastUpper, chartSpec, Qt::DotLine);
+        drawCurve(painter, Qt::darkRed, forecastExpected, chartSpec, Qt::DashLine);
+
+        // Annotation markers along the top of the plot area
+        painter.setPen(QPen(Qt::darkGray, 1, Qt::DashLine));
+        for (const sv::Annotation& annotation : annotations)
+        {
+            if (annotation.timestamp < chartSpec.minX || annotation.timestamp > chartSpec.maxX)
+                continue;
+
+            const double x = chartSpec.leftMargin + (annotation.timestamp - chartSpec.minX) * chartSpec.xScale;
+            painter.drawLine(QPointF(x, chartSpec.topMargin), QPointF(x, chartSpec.topMargin + chartSpec.height));
+
+            painter.save();
+            painter.translate(x + 3, chartSpec.topMargin + 5);
+            painter.rotate(90);
+            painter.drawText(0, 0, annotation.text);
+            painter.restore();
+        }
+        painter.restore();
+
         // Calculate legend box size based on text width
         int legendTextWidth = fm.horizontalAdvance(legendData);
         int legendBoxWidth = legendTextWidth + 40;  // Add padding for the line and spacing
@@ -191,9 +305,9 @@ void ChartWidget::paintEvent(QPaintEvent* event)
 }
 
 QPen ChartWidget::drawCurve(QPainter& painter, Qt::GlobalColor penColor, const QVector<QPointF>& data,
-                            const ChartSpec& chartSpec)
+                            const ChartSpec& chartSpec, Qt::PenStyle penStyle)
 {
-    QPen chartPen(penColor, 2);
+    QPen chartPen(penColor, 2, penStyle);
     painter.setPen(chartPen);
 
     QPointF previousPoint;
@@ -38,6 +38,22 @@ struct ChartSpec
         yScale = height / (maxY - minY);
     }
 
+    // Show only [fromX, toX], fitting the y axis to the points inside it
+    void setScale(const QVector<QPointF>& data, double fromX, double toX)
+    {
+        QVector<QPointF> visible;
+        for (const QPointF& point : data)
+        {
+            if (point.x() >= fromX && point.x() <= toX)
+                visible.append(point);
+        }
+
+        setScale(visible.size() >= 2 ? visible : data);
+        minX = fromX;
+        maxX = toX;
+        xScale = width / (maxX - minX);
+    }
+
     double leftMargin;
     double rightMargin;
     double topMargin;
@@ -63,24 +79,47 @@ public:
 
     void setAllData(const sv::StockDataResult& result);
     void appendData(const QVector<QPointF>& data);
+    // Extend the main series, e.g. with bars arriving live
+    void appendPoints(const QVector<QPointF>& points);
     void setData(const QVector<QPointF>& data, const QMap<QString, QString>& labelData);
     void setAxisTitles(const QString& xTitle, const QString& yTitle);
     void setLegendData(const QString& legendData);
     void setTitle(const QString& title);
+    void setOverlays(const QVector<sv::StockDataResult>& overlays);
+    void setAnnotations(const QVector<sv::Annotation>& annotations);
+    // Projection past the last bar with its band; empty vectors clear it
+    void setForecast(const QVector<QPointF>& expected, const QVector<QPointF>& lower, const QVector<QPointF>& upper);
+
+    // Visible time range; from == to shows the whole series
+    void setXRange(double from, double to);
+    double getXFrom() const { return xFrom; }
+    double getXTo() const { return xTo; }
+    void resetZoom() { setXRange(0, 0); }
+
 protected:
 
     void paintEvent(QPaintEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
 
 private:
-    QPen drawCurve(QPainter& painter, Qt::GlobalColor penColor, const QVector<QPointF>& data, const ChartSpec& chartSpec);
+    QPen drawCurve(QPainter& painter, Qt::GlobalColor penColor, const QVector<QPointF>& data, const ChartSpec& chartSpec,
+                   Qt::PenStyle penStyle = Qt::SolidLine);
 
     ChartSpec chartSpec;
     QVector<QPointF> rawData;
     QVector<QPointF> estimateData;
+    QVector<sv::StockDataResult> overlays;
+    QVector<sv::Annotation> annotations;
+    QVector<QPointF> forecastExpected;
+    QVector<QPointF> forecastLower;
+    QVector<QPointF> forecastUpper;
     QString xAxisTitle;
     QString yAxisTitle;
     QString chartTitle;
     QString legendData;
+    double xFrom = 0;
+    double xTo = 0;
 };
 
 #endif // CHARTWIDGET_HPP
@@ -0,0 +1,447 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+#include "CorrelationEngine.hpp"
+
+namespace sv
+{
+
+namespace
+{
+
+// Square tiles of the product matrix; 64 x 64 doubles stay resident in L1/L2
+const int tileSize = 64;
+
+// Below this many multiply-adds a single thread is faster than spawning workers
+const double parallelThreshold = 2e7;
+
+}
+
+AlignedCloses AlignedCloses::align(const QVector<SeriesPtr>& series)
+{
+    AlignedCloses result;
+    if (series.isEmpty())
+        return result;
+
+    std::vector<double> common(series[0]->column(Series::Time), series[0]->column(Series::Time) + series[0]->size());
+    common.erase(std::unique(common.begin(), common.end()), common.end());
+
+    for (int k = 1; k < series.size() && !common.empty(); ++k)
+    {
+        const double* time = series[k]->column(Series::Time);
+        std::vector<double> intersection;
+        intersection.reserve(common.size());
+        std::set_intersection(common.begin(), common.end(), time, time + series[k]->size(),
+                              std::back_inserter(intersection));
+        intersection.erase(std::unique(intersection.begin(), intersection.end()), intersection.end());
+        common = std::move(intersection);
+    }
+
+    const int n = series.size();
+    const int rows = static_cast<int>(common.size());
+
+    for (const SeriesPtr& entry : series)
+        result.symbols << entry->getSymbol();
+    result.time = QVector<double>(common.begin(), common.end());
+    result.closes = QVector<double>(rows * n);
+
+    double* closes = result.closes.data();
+    for (int k = 0; k < n; ++k)
+    {
+        const double* time = series[k]->column(Series::Time);
+        const double* close = series[k]->column(Series::Close);
+        int j = 0;
+        for (int t = 0; t < rows; ++t)
+        {
+            while (time[j] < common[t])
+                ++j;
+            closes[t * n + k] = close[j];
+        }
+    }
+
+    return result;
+}
+
+CorrelationEngine::CorrelationEngine(int window)
+    : window(window > 1 ? window : 0)
+{
+}
+
+void CorrelationEngine::update(const QVector<SeriesPtr>& series)
+{
+    // A stable order, so the same symbols never look like a different matrix
+    QVector<SeriesPtr> sorted = series;
+    std::sort(sorted.begin(), sorted.end(), [](const SeriesPtr& a, const SeriesPtr& b)
+              { return a->getSymbol() < b->getSymbol(); });
+    const AlignedCloses aligned = AlignedCloses::align(sorted);
+
+    if (n == 0 || aligned.symbols != labels)
+    {
+        rebuild(aligned);
+        return;
+    }
+
+    // Only bars after the last applied one are new; the shared history must be unchanged
+    const auto firstNew = std::upper_bound(aligned.time.cbegin(), aligned.time.cend(), lastTime);
+    const int start = static_cast<int>(firstNew - aligned.time.cbegin());
+
+    if (start == 0 || aligned.time[start - 1] != lastTime)
+    {
+        rebuild(aligned);
+        return;
+    }
+
+    if (!std::equal(lastClose.begin(), lastClose.end(), aligned.closes.cbegin() + (start - 1) * n))
+    {
+        // A revised latest bar is replaced as long as the bar before it is unchanged
+        const bool previousUnchanged = lastRow.empty()
+            ? start == 1
+            : start >= 2 && std::equal(previousClose.begin(), previousClose.end(), aligned.closes.cbegin() + (start - 2) * n);
+        if (!previousUnchanged)
+        {
+            rebuild(aligned);
+            return;
+        }
+        replaceLastRow(aligned.closes.mid((start - 1) * n, n));
+    }
+
+    for (int t = start; t < aligned.time.size(); ++t)
+        appendRow(aligned.time[t], aligned.closes.mid(t * n, n));
+    clearStaged();
+}
+
+void CorrelationEngine::appendRow(double time, const QVector<double>& closes)
+{
+    if (n == 0 || closes.size() != n || time <= lastTime)
+        return;
+
+    std::vector<double> row(n);
+    for (int i = 0; i < n; ++i)
+        row[i] = std::log(closes[i] / lastClose[i]);
+    previousClose = lastClose;
+    lastClose.assign(closes.cbegin(), closes.cend());
+    revisedClose = lastClose;
+    lastRow = row;
+    lastTime = time;
+
+    if (window > 0)
+    {
+        double* slot = retained.data() + static_cast<size_t>(retainedHead) * n;
+        if (retainedCount == window)
+            accumulate(slot, 1, -1);
+        else
+            ++retainedCount;
+
+        std::copy(row.begin(), row.end(), slot);
+        retainedHead = (retainedHead + 1) % window;
+        count = retainedCount;
+
+        if (++appendsSinceRebuild >= window)
+        {
+            recomputeFromRetained();
+            cacheValid = false;
+            return;
+        }
+    }
+    else
+    {
+        ++count;
+    }
+
+    accumulate(row.data(), 1, 1);
+    cacheValid = false;
+}
+
+void CorrelationEngine::replaceLastRow(const QVector<double>& closes)
+{
+    if (n == 0 || closes.size() != n)
+        return;
+
+    lastClose.assign(closes.cbegin(), closes.cend());
+    revisedClose = lastClose;
+    if (lastRow.empty())
+        return;
+
+    std::vector<double> row(n);
+    for (int i = 0; i < n; ++i)
+        row[i] = std::log(closes[i] / previousClose[i]);
+
+    accumulate(lastRow.data(), 1, -1);
+    accumulate(row.data(), 1, 1);
+    lastRow = row;
+    cacheValid = false;
+
+    if (window > 0)
+    {
+        // The newest retained row is the one before the head
+        std::copy(row.begin(), row.end(), retained.begin() + static_cast<size_t>((retainedHead + window - 1) % window) * n);
+        if (++appendsSinceRebuild >= window)
+            recomputeFromRetained();
+    }
+}
+
+bool CorrelationEngine::stage(const Series& series)
+{
+    const auto column = columns.constFind(series.getSymbol());
+    if (column == columns.constEnd() || series.isEmpty())
+        return false;
+
+    const int k = column.value();
+    const int size = series.size();
+    const double* time = series.column(Series::Time);
+    const double* close = series.column(Series::Close);
+    bool changed = false;
+
+    int first = static_cast<int>(std::lower_bound(time, time + size, lastTime) - time);
+    if (first < size && time[first] == lastTime)
+    {
+        if (close[first] != revisedClose[k])
+        {
+            revisedClose[k] = close[first];
+            revised = true;
+            changed = true;
+        }
+        ++first;
+    }
+
+    std::map<double, double>& bars = stagedBars[k];
+    for (int i = first; i < size; ++i)
+    {
+        const auto it = bars.find(time[i]);
+        if (it == bars.end() || it->second != close[i])
+        {
+            bars[time[i]] = close[i];
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool CorrelationEngine::commit()
+{
+    bool changed = false;
+    if (revised)
+    {
+        revised = false;
+        if (revisedClose != lastClose)
+        {
+            replaceLastRow(QVector<double>(revisedClose.begin(), revisedClose.end()));
+            changed = true;
+        }
+    }
+
+    // The next time every series has a bar for; bars some series skip are dropped,
+    // as align() drops times that are not common to all
+    for (;;)
+    {
+        double next = lastTime;
+        for (std::map<double, double>& bars : stagedBars)
+        {
+            bars.erase(bars.begin(), bars.upper_bound(lastTime));
+            if (bars.empty())
+                return changed;
+            next = std::max(next, bars.begin()->first);
+        }
+
+        QVector<double> closes(n);
+        bool complete = true;
+        for (int k = 0; k < n; ++k)
+        {
+            std::map<double, double>& bars = stagedBars[k];
+            bars.erase(bars.begin(), bars.lower_bound(next));
+            if (bars.empty() || bars.begin()->first != next)
+                complete = false;
+            else
+                closes[k] = bars.begin()->second;
+        }
+
+        if (complete)
+        {
+            appendRow(next, closes);
+            changed = true;
+        }
+    }
+}
+
+void CorrelationEngine::clearStaged()
+{
+    revisedClose = lastClose;
+    revised = false;
+    for (std::map<double, double>& bars : stagedBars)
+        bars.clear();
+}
+
+QVector<double> CorrelationEngine::covariance() const
+{
+    QVector<double> result(n * n, 0.0);
+    if (count < 2)
+        return result;
+
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = i; j < n; ++j)
+        {
+            const double value = (products[i * n + j] - sums[i] * sums[j] / count) / (count - 1);
+            result[i * n + j] = value;
+            result[j * n + i] = value;
+        }
+    }
+    return result;
+}
+
+QVector<double> CorrelationEngine::correlation() const
+{
+    if (cacheValid)
+        return cachedCorrelation;
+
+    QVector<double> result = covariance();
+    std::vector<double> deviation(n);
+    for (int i = 0; i < n; ++i)
+        deviation[i] = std::sqrt(std::max(result[i * n + i], 0.0));
+
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            const double denominator = deviation[i] * deviation[j];
+            result[i * n + j] = denominator > 0 ? result[i * n + j] / denominator : (i == j ? 1 : 0);
+        }
+    }
+
+    cachedCorrelation = result;
+    cacheValid = true;
+    return result;
+}
+
+void CorrelationEngine::rebuild(const AlignedCloses& aligned)
+{
+    labels = aligned.symbols;
+    n = labels.size();
+    count = 0;
+    appendsSinceRebuild = 0;
+    retainedHead = 0;
+    retainedCount = 0;
+    cacheValid = false;
+
+    sums.assign(n, 0.0);
+    products.assign(static_cast<size_t>(n) * n, 0.0);
+    retained.assign(static_cast<size_t>(window) * n, 0.0);
+    lastClose.assign(n, 0.0);
+    previousClose.assign(n, 0.0);
+    lastRow.clear();
+    lastTime = 0;
+
+    columns.clear();
+    for (int k = 0; k < n; ++k)
+        columns.insert(labels[k], k);
+    stagedBars.assign(n, std::map<double, double>());
+    clearStaged();
+
+    const int rows = aligned.time.size();
+    if (n == 0 || rows == 0)
+        return;
+
+    const double* closes = aligned.closes.constData();
+    std::copy(closes + (rows - 1) * n, closes + rows * n, lastClose.begin());
+    revisedClose = lastClose;
+    lastTime = aligned.time.last();
+    if (rows >= 2)
+        std::copy(closes + (rows - 2) * n, closes + (rows - 1) * n, previousClose.begin());
+
+    // Log returns of the rows that fall inside the window
+    const int firstRow = window > 0 ? std::max(1, rows - window) : 1;
+    const int returnRows = rows - firstRow;
+    if (returnRows <= 0)
+        return;
+
+    std::vector<double> returns(static_cast<size_t>(returnRows) * n);
+    for (int t = 0; t < returnRows; ++t)
+    {
+        const double* current = closes + (firstRow + t) * n;
+        const double* previous = current - n;
+        double* output = returns.data() + static_cast<size_t>(t) * n;
+        for (int i = 0; i < n; ++i)
+            output[i] = std::log(current[i] / previous[i]);
+    }
+
+    if (window > 0)
+    {
+        std::copy(returns.begin(), returns.end(), retained.begin());
+        retainedCount = returnRows;
+        retainedHead = returnRows % window;
+    }
+
+    count = returnRows;
+    lastRow.assign(returns.end() - n, returns.end());
+    accumulate(returns.data(), returnRows, 1);
+}
+
+void CorrelationEngine::recomputeFromRetained()
+{
+    std::fill(sums.begin(), sums.end(), 0.0);
+    std::fill(products.begin(), products.end(), 0.0);
+    accumulate(retained.data(), retainedCount, 1);
+    appendsSinceRebuild = 0;
+}
+
+void CorrelationEngine::accumulate(const double* rows, int rowCount, double sign)
+{
+    for (int t = 0; t < rowCount; ++t)
+    {
+        const double* row = rows + static_cast<size_t>(t) * n;
+        for (int i = 0; i < n; ++i)
+            sums[i] += sign * row[i];
+    }
+
+    // Upper-triangle tiles of the cross-product matrix. Each tile streams over
+    // all rows as rank-1 updates whose inner loop is a contiguous axpy, which
+    // the compiler vectorizes; tiles are disjoint so workers never contend.
+    std::vector<std::pair<int, int>> tiles;
+    for (int ib = 0; ib < n; ib += tileSize)
+        for (int jb = ib; jb < n; jb += tileSize)
+            tiles.emplace_back(ib, jb);
+
+    const int columns = n;
+    double* productData = products.data();
+    std::atomic<int> nextTile{0};
+
+    auto worker = [&]()
+    {
+        for (int index = nextTile.fetch_add(1); index < static_cast<int>(tiles.size()); index = nextTile.fetch_add(1))
+        {
+            const int ib = tiles[index].first;
+            const int jb = tiles[index].second;
+            const int iEnd = std::min(ib + tileSize, columns);
+            const int jEnd = std::min(jb + tileSize, columns);
+
+            for (int t = 0; t < rowCount; ++t)
+            {
+                const double* row = rows + static_cast<size_t>(t) * columns;
+                for (int i = ib; i < iEnd; ++i)
+                {
+                    const double a = sign * row[i];
+                    double* product = productData + static_cast<size_t>(i) * columns;
+                    for (int j = std::max(jb, i); j < jEnd; ++j)
+                        product[j] += a * row[j];
+                }
+            }
+        }
+    };
+
+    const double work = static_cast<double>(rowCount) * n * n / 2;
+    const int threadCount = work < parallelThreshold
+        ? 1 : std::min<int>(std::max(1u, std::thread::hardware_concurrency()), static_cast<int>(tiles.size()));
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+}
@@ -0,0 +1,127 @@
+#ifndef CORRELATIONENGINE_HPP
+#define CORRELATIONENGINE_HPP
+
+#include <map>
+#include <vector>
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+#include "Series.hpp"
+
+namespace sv
+{
+
+// Closing prices of several series restricted to the timestamps they all share
+struct AlignedCloses
+{
+    QStringList symbols;
+    QVector<double> time;
+    QVector<double> closes;          // row-major, time.size() x symbols.size()
+
+    static AlignedCloses align(const QVector<SeriesPtr>& series);
+};
+
+/**
+ * @brief Pairwise covariance/correlation of log returns across many series.
+ *
+ * The engine keeps running sums and cross-products of the returns, so the
+ * matrices are derived in O(N^2) and a newly appended common bar costs one
+ * rank-1 update instead of a full recomputation. A revised latest bar (an
+ * intraday quote) subtracts the last row and adds it back revised. With a
+ * rolling window the row leaving the window is subtracted again; the sums are
+ * rebuilt from the retained rows once per window length to keep rounding
+ * error bounded.
+ *
+ * Series are ordered by symbol. Live updates arrive one series at a time
+ * through stage(); commit() applies them once every series has the new bar.
+ */
+class CorrelationEngine
+{
+public:
+    /**
+     * @param window Number of most recent returns to use; 0 uses the full history.
+     */
+    explicit CorrelationEngine(int window = 0);
+
+    /**
+     * @brief Bring the engine up to date with the given series, in any order.
+     *        When the symbols are unchanged and the series only grew or had
+     *        their latest bar revised, just the changes are applied; anything
+     *        else triggers a full rebuild.
+     */
+    void update(const QVector<SeriesPtr>& series);
+
+    /**
+     * @brief Apply one new bar; closes are ordered like symbols().
+     */
+    void appendRow(double time, const QVector<double>& closes);
+
+    // Revise the latest bar; closes are ordered like symbols()
+    void replaceLastRow(const QVector<double>& closes);
+
+    /**
+     * @brief Queue the changes in a new version of one series: a revised
+     *        latest bar, and bars newer than it. Nothing is recomputed yet.
+     * @return False if the symbol is not in the matrix or nothing changed.
+     */
+    bool stage(const Series& series);
+
+    /**
+     * @brief Apply the staged revisions as one replaced row, then every new
+     *        time all series have a staged bar for.
+     * @return True if the matrix changed.
+     */
+    bool commit();
+
+    QStringList symbols() const
+    {
+        return labels;
+    }
+
+    int observations() const
+    {
+        return count;
+    }
+
+    QVector<double> covariance() const;
+    QVector<double> correlation() const;
+
+private:
+    void rebuild(const AlignedCloses& aligned);
+    void accumulate(const double* rows, int rowCount, double sign);
+    void recomputeFromRetained();
+    void clearStaged();
+
+    int window;
+    int n = 0;
+    int count = 0;
+    int appendsSinceRebuild = 0;
+    QStringList labels;
+    double lastTime = 0;
+
+    std::vector<double> lastClose;
+    std::vector<double> previousClose;
+    std::vector<double> lastRow;     // return row of the latest bar, once there is one
+    std::vector<double> sums;
+    std::vector<double> products;    // upper triangle of an n x n row-major matrix
+
+    // Most recent `window` return rows, used to retire rows and to rebuild
+    std::vector<double> retained;
+    int retainedHead = 0;
+    int retainedCount = 0;
+
+    // Changes from stage() not yet applied, by column
+    QHash<QString, int> columns;
+    std::vector<double> revisedClose;
+    bool revised = false;
+    std::vector<std::map<double, double>> stagedBars;
+
+    mutable bool cacheValid = false;
+    mutable QVector<double> cachedCorrelation;
+};
+
+}
+
+#endif // CORRELATIONENGINE_HPP
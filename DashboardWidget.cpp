@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <QFontMetrics>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPolygonF>
+#include <QScrollBar>
+
+#include "DashboardWidget.hpp"
+
+namespace
+{
+
+const int minimumTileWidth = 220;
+const double tileAspect = 0.6;
+
+// Runs on a render thread: only the arguments may be touched
+QImage renderTile(const QString& symbol, const sv::SeriesPtr& series, const QSize& size, qreal devicePixelRatio)
+{
+    QImage image(size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    const QRectF bounds(0, 0, size.width(), size.height());
+    painter.setPen(QColor(220, 220, 220));
+    painter.drawRect(bounds.adjusted(0, 0, -1, -1));
+
+    QFont font = painter.font();
+    font.setPointSize(9);
+    font.setBold(true);
+    painter.setFont(font);
+    const QFontMetrics fm(font);
+    const QRectF header = bounds.adjusted(6, 4, -6, 0);
+
+    painter.setPen(Qt::black);
+    painter.drawText(header, Qt::AlignLeft | Qt::AlignTop, symbol);
+
+    if (series.isNull() || series->size() < 2)
+    {
+        painter.setPen(Qt::gray);
+        painter.drawText(bounds, Qt::AlignCenter, "No data");
+        return image;
+    }
+
+    const int n = series->size();
+    const double* time = series->column(sv::Series::Time);
+    const double* close = series->column(sv::Series::Close);
+    const double change = close[n - 2] != 0 ? (close[n - 1] / close[n - 2] - 1) * 100 : 0;
+    const QColor trend = change >= 0 ? QColor(0, 140, 0) : QColor(200, 0, 0);
+
+    painter.setPen(trend);
+    painter.drawText(header, Qt::AlignRight | Qt::AlignTop,
+                     QString("%1  %2%3%").arg(close[n - 1], 0, 'f', 2).arg(change >= 0 ? "+" : "").arg(change, 0, 'f', 2));
+
+    const QRectF plot = bounds.adjusted(6, 8 + fm.height(), -6, -6);
+    if (plot.width() < 2 || plot.height() < 2)
+        return image;
+
+    // One low/high pair per pixel column keeps the path short however long the history
+    const int buckets = std::max(1, static_cast<int>(plot.width() * devicePixelRatio));
+    QVector<double> low(buckets, std::numeric_limits<double>::infinity());
+    QVector<double> high(buckets, -std::numeric_limits<double>::infinity());
+    const double span = std::max(time[n - 1] - time[0], 1e-9);
+    double minY = close[0];
+    double maxY = close[0];
+
+    for (int i = 0; i < n; ++i)
+    {
+        const int bucket = std::min(buckets - 1, static_cast<int>((time[i] - time[0]) / span * buckets));
+        low[bucket] = std::min(low[bucket], close[i]);
+        high[bucket] = std::max(high[bucket], close[i]);
+        minY = std::min(minY, close[i]);
+        maxY = std::max(maxY, close[i]);
+    }
+    if (minY == maxY)
+    {
+        minY -= 1;
+        maxY += 1;
+    }
+
+    const double yScale = plot.height() / (maxY - minY);
+    QPolygonF path;
+    path.reserve(2 * buckets);
+    for (int bucket = 0; bucket < buckets; ++bucket)
+    {
+        if (low[bucket] > high[bucket])
+            continue;
+
+        const double x = plot.left() + (bucket + 0.5) * plot.width() / buckets;
+        path << QPointF(x, plot.bottom() - (high[bucket] - minY) * yScale);
+        if (low[bucket] != high[bucket])
+            path << QPointF(x, plot.bottom() - (low[bucket] - minY) * yScale);
+    }
+
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(QPen(trend, 1.2));
+    painter.drawPolyline(path);
+    return image;
+}
+
+}
+
+DashboardWidget::DashboardWidget(QWidget* parent) : QAbstractScrollArea(parent)
+{
+    viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setMinimumSize(minimumTileWidth + 40, 200);
+
+    // Snapshot on the GUI thread; series are immutable, so sharing them is enough
+    scheduler.setJobFactory([this](int tile) -> RenderScheduler::RenderJob
+    {
+        const QString symbol = tiles[tile].symbol;
+        const sv::SeriesPtr series = tiles[tile].series;
+        const QSize size = tileSize;
+        const qreal devicePixelRatio = viewport()->devicePixelRatioF();
+        return [symbol, series, size, devicePixelRatio]()
+        {
+            return renderTile(symbol, series, size, devicePixelRatio);
+        };
+    });
+
+    connect(&scheduler, &RenderScheduler::tileRendered, this, [this](int tile, const QImage& image)
+    {
+        tiles[tile].image = image;
+        viewport()->update(tileRect(tile).translated(0, -verticalScrollBar()->value()));
+    });
+}
+
+void DashboardWidget::setSymbols(const QStringList& symbols)
+{
+    // Resetting the scheduler drops renders in flight, so only do it for a new list
+    if (symbols.size() == tiles.size()
+        && std::equal(symbols.cbegin(), symbols.cend(), tiles.cbegin(),
+                      [](const QString& symbol, const Tile& tile) { return tile.symbol == symbol; }))
+        return;
+
+    QVector<Tile> updated;
+    updated.reserve(symbols.size());
+    for (const QString& symbol : symbols)
+    {
+        const auto existing = std::find_if(tiles.cbegin(), tiles.cend(),
+                                           [&symbol](const Tile& tile) { return tile.symbol == symbol; });
+        updated.append(existing != tiles.cend() ? *existing : Tile{ symbol, {}, {} });
+    }
+
+    tiles = updated;
+    scheduler.reset(tiles.size());
+    updateLayout();
+    viewport()->update();
+}
+
+void DashboardWidget::setSeries(const QString& symbol, const sv::SeriesPtr& series)
+{
+    for (int tile = 0; tile < tiles.size(); ++tile)
+    {
+        if (tiles[tile].symbol == symbol && tiles[tile].series != series)
+        {
+            tiles[tile].series = series;
+            scheduler.invalidate(tile);
+        }
+    }
+}
+
+QRect DashboardWidget::tileRect(int tile) const
+{
+    return QRect(QPoint((tile % columns) * tileSize.width(), (tile / columns) * tileSize.height()), tileSize);
+}
+
+int DashboardWidget::tileAt(const QPoint& position) const
+{
+    if (tileSize.isEmpty() || position.x() < 0 || position.x() >= columns * tileSize.width())
+        return -1;
+
+    const int row = (position.y() + verticalScrollBar()->value()) / tileSize.height();
+    const int tile = row * columns + position.x() / tileSize.width();
+    return tile < tiles.size() ? tile : -1;
+}
+
+void DashboardWidget::updateLayout()
+{
+    const int width = viewport()->width();
+    columns = std::max(1, width / minimumTileWidth);
+
+    const QSize size(std::max(1, width / columns), std::max(100, static_cast<int>(width / columns * tileAspect)));
+    if (size != tileSize)
+    {
+        // Old images are stretched until the new ones arrive
+        tileSize = size;
+        scheduler.invalidateAll();
+    }
+
+    const int rows = (tiles.size() + columns - 1) / columns;
+    verticalScrollBar()->setRange(0, std::max(0, rows * tileSize.height() - viewport()->height()));
+    verticalScrollBar()->setPageStep(viewport()->height());
+    verticalScrollBar()->setSingleStep(tileSize.height() / 4);
+
+    updateVisibility();
+}
+
+void DashboardWidget::updateVisibility()
+{
+    const QRect visible(0, verticalScrollBar()->value(), viewport()->width(), viewport()->height());
+    for (int tile = 0; tile < tiles.size(); ++tile)
+        scheduler.setVisible(tile, visible.intersects(tileRect(tile)));
+}
+
+void DashboardWidget::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), Qt::white);
+
+    const int offset = verticalScrollBar()->value();
+    for (int tile = 0; tile < tiles.size(); ++tile)
+    {
+        const QRect target = tileRect(tile).translated(0, -offset);
+        if (!target.intersects(event->rect()))
+            continue;
+
+        if (tiles[tile].image.isNull())
+        {
+            painter.setPen(Qt::gray);
+            painter.drawText(target, Qt::AlignCenter, tiles[tile].symbol);
+        }
+        else
+        {
+            painter.drawImage(target, tiles[tile].image);
+        }
+    }
+}
+
+void DashboardWidget::resizeEvent(QResizeEvent* event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateLayout();
+}
+
+void DashboardWidget::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    viewport()->update();
+    updateVisibility();
+}
+
+void DashboardWidget::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    const int tile = tileAt(event->pos());
+    if (tile >= 0)
+        emit symbolActivated(tiles[tile].symbol);
+}
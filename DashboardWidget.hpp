@@ -0,0 +1,62 @@
+#ifndef DASHBOARDWIDGET_HPP
+#define DASHBOARDWIDGET_HPP
+
+#include <QAbstractScrollArea>
+#include <QImage>
+#include <QStringList>
+#include <QVector>
+
+#include "RenderScheduler.hpp"
+#include "Series.hpp"
+
+// Scrollable grid of small price charts, one per symbol, drawn from images
+// that a shared RenderScheduler renders in the background
+class DashboardWidget : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+
+    explicit DashboardWidget(QWidget* parent = nullptr);
+
+    void setSymbols(const QStringList& symbols);
+
+    // Ignored for symbols that are not on the dashboard
+    void setSeries(const QString& symbol, const sv::SeriesPtr& series);
+
+    void setMaxFramesPerSecond(int framesPerSecond)
+    {
+        scheduler.setMaxFramesPerSecond(framesPerSecond);
+    }
+
+signals:
+
+    void symbolActivated(const QString& symbol);
+
+protected:
+
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+
+private:
+    struct Tile
+    {
+        QString symbol;
+        sv::SeriesPtr series;
+        QImage image;
+    };
+
+    void updateLayout();
+    void updateVisibility();
+    QRect tileRect(int tile) const;          // in content coordinates
+    int tileAt(const QPoint& position) const; // viewport coordinates; -1 if none
+
+    QVector<Tile> tiles;
+    RenderScheduler scheduler;
+    int columns = 1;
+    QSize tileSize;
+};
+
+#endif // DASHBOARDWIDGET_HPP
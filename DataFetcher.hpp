@@ -1,13 +1,18 @@
 #ifndef DATAFETCHER_HPP
 #define DATAFETCHER_HPP
 
-#include <exception>
+#include <algorithm>
 
 #include <QUrl>
 #include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QQueue>
+#include <QTimer>
 
 #include "QueryBuilder.hpp"
 #include "QtUtils.hpp"
+#include "StockParser.hpp"
 
 class DataFetcher : public QObject
 {
@@ -22,38 +27,131 @@ public:
         sourceUrl = env.value("URL", "default_value_if_not_set");
         function = env.value("FUNCTION", "default_value_if_not_set");
 
-        if (env.contains("API_KEY"))
-            qDebug() << "API_KEY:" << apiKey;
-        else
-            throw std::runtime_error{"API_KEY not found in environment"};
-        if (env.contains("URL"))
-            qDebug() << "URL:" << sourceUrl;
-        else
-            throw std::runtime_error{"URL not found in environment"};
-        if (env.contains("FUNCTION"))
-            qDebug() << "FUNCTION:" << function;
+        // Optional multi-symbol quote endpoint, e.g. REALTIME_BULK_QUOTES
+        bulkFunction = env.value("BULK_FUNCTION");
+        bulkDataType = env.value("BULK_DATATYPE");
+        maxBatchSize = std::max(1, env.value("BULK_BATCH_SIZE", "100").toInt());
+
+        // A missing key only disables fetching, so cached series still open offline
+        for (const QString& key : { QStringLiteral("API_KEY"), QStringLiteral("URL"), QStringLiteral("FUNCTION") })
+        {
+            if (!env.contains(key))
+                configurationError = key + " not found in environment";
+        }
+
+        if (configurationError.isEmpty())
+            qDebug() << "URL:" << sourceUrl << "FUNCTION:" << function;
         else
-            throw std::runtime_error{"FUNCTION not found in environment"};
+            qWarning() << configurationError;
 
+        batchTimer.setSingleShot(true);
+        batchTimer.setInterval(50);
+        connect(&batchTimer, &QTimer::timeout, this, &DataFetcher::flushQuotes);
     }
 
-    void MakeQuery(const QString& tickerSymbol) const
+    // Point the fetcher somewhere other than stockview.env says, e.g. the mock server
+    void setEndpoint(const QString& url, const QString& function, const QString& apiKey)
     {
-        QueryBuilder queryBuilder = QueryBuilder::create()
-            .setAnalyticsUrl(sourceUrl)
-            .setFunction(function)
-            .setTickerSymbol(tickerSymbol)
-            .setApiKey(apiKey);
-        QString query = queryBuilder.build();
+        sourceUrl = url;
+        this->function = function;
+        this->apiKey = apiKey;
+        configurationError.clear();
+    }
 
-        QNetworkRequest request{ QUrl{query} };
-        networkManager->get(request);
+    void setBulkEndpoint(const QString& function, int maxBatchSize)
+    {
+        bulkFunction = function;
+        this->maxBatchSize = std::max(1, maxBatchSize);
+    }
+
+    bool isConfigured() const
+    {
+        return configurationError.isEmpty();
+    }
+
+    bool supportsBulkQuotes() const
+    {
+        return isConfigured() && !bulkFunction.isEmpty();
+    }
+
+    int getMaxBatchSize() const
+    {
+        return maxBatchSize;
+    }
+
+    QString getConfigurationError() const
+    {
+        return configurationError;
+    }
 
+    /**
+     * @brief Queue a request for the ticker. At most maxInFlight requests are
+     *        outstanding at once; each must be handed back with release() when
+     *        its result has been consumed, which admits the next one.
+     * @param tailOnly Only ask for the most recent bars, for symbols whose
+     *                 older history is already cached.
+     */
+    void MakeQuery(const QString& tickerSymbol, bool tailOnly = false)
+    {
+        if (!isConfigured())
+        {
+            emit queryFailed(tickerSymbol, configurationError);
+            return;
+        }
+
+        pendingQueries.enqueue(PendingQuery{ tickerSymbol, tailOnly, {} });
+        dispatch();
+    }
+
+    /**
+     * @brief Ask for the latest quote of the ticker. Requests arriving within
+     *        a short window are coalesced into bulk requests of up to
+     *        maxBatchSize symbols, each taking one in-flight slot, and the
+     *        response is split back into quoteReceived per ticker. Without a
+     *        bulk endpoint this falls back to a tail query.
+     */
+    void requestQuote(const QString& tickerSymbol)
+    {
+        if (!supportsBulkQuotes())
+        {
+            MakeQuery(tickerSymbol, true);
+            return;
+        }
+
+        if (!pendingQuotes.contains(tickerSymbol))
+            pendingQuotes.append(tickerSymbol);
+
+        if (pendingQuotes.size() >= maxBatchSize)
+            flushQuotes();
+        else if (!batchTimer.isActive())
+            batchTimer.start();
+    }
+
+    void release()
+    {
+        if (inFlight > 0)
+            --inFlight;
+        dispatch();
+    }
+
+    void setMaxInFlight(int maxInFlight)
+    {
+        this->maxInFlight = maxInFlight > 0 ? maxInFlight : 1;
+        dispatch();
     }
 
     void setNetworkManager(QNetworkAccessManager* networkManager)
     {
         this->networkManager = networkManager;
+        if (!isConfigured())
+            return;
+
+        // Open the connection (and TLS session) before the first query needs it
+        const QUrl url{sourceUrl};
+        if (url.scheme() == QLatin1String("https"))
+            networkManager->connectToHostEncrypted(url.host(), url.port(443));
+        else if (url.scheme() == QLatin1String("http"))
+            networkManager->connectToHost(url.host(), url.port(80));
     }
 
     QNetworkAccessManager* getNetworkManager() const
@@ -61,11 +159,125 @@ public:
         return networkManager;
     }
 
+signals:
+    // A request went out; its body can be consumed incrementally via readyRead
+    void querySent(QNetworkReply* reply, const QString& tickerSymbol);
+
+    // The request could not be made at all, e.g. stockview.env lacks a key
+    void queryFailed(const QString& tickerSymbol, const QString& error);
+
+    // One ticker's share of a bulk quote response, as a daily bar
+    void quoteReceived(const QString& tickerSymbol, const sv::Bar& bar);
+
 private:
-    QNetworkAccessManager* networkManager;
+    void dispatch()
+    {
+        while (inFlight < maxInFlight && !pendingQueries.isEmpty())
+        {
+            ++inFlight;
+            const PendingQuery query = pendingQueries.dequeue();
+            if (query.batch.isEmpty())
+                sendQuery(query.tickerSymbol, query.tailOnly);
+            else
+                sendBatch(query.batch);
+        }
+    }
+
+    void flushQuotes()
+    {
+        batchTimer.stop();
+        while (!pendingQuotes.isEmpty())
+        {
+            const QStringList batch = pendingQuotes.mid(0, maxBatchSize);
+            pendingQuotes = pendingQuotes.mid(batch.size());
+            pendingQueries.enqueue(PendingQuery{ QString(), true, batch });
+        }
+        dispatch();
+    }
+
+    // Bulk replies are consumed here rather than through querySent, and release their own slot
+    void sendBatch(const QStringList& tickerSymbols)
+    {
+        QueryBuilder queryBuilder = QueryBuilder::create()
+            .setAnalyticsUrl(sourceUrl)
+            .setFunction(bulkFunction)
+            .setTickerSymbols(tickerSymbols)
+            .setApiKey(apiKey);
+        if (!bulkDataType.isEmpty())
+            queryBuilder.addParameter("datatype", bulkDataType);
+
+        QNetworkRequest request{ QUrl{queryBuilder.build()} };
+        request.setRawHeader("Connection", "keep-alive");
+        request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+        QNetworkReply* reply = networkManager->get(request);
+        reply->setProperty("batch", true);
+
+        connect(reply, &QNetworkReply::finished, this, [this, reply, tickerSymbols]()
+        {
+            QString error;
+            QMap<QString, sv::Bar> quotes;
+            if (reply->error() == QNetworkReply::NoError)
+                quotes = sv::parseBulkQuotes(reply->readAll(), &error);
+            else
+                error = reply->errorString();
+            reply->deleteLater();
+            release();
+
+            for (const QString& tickerSymbol : tickerSymbols)
+            {
+                const auto quote = quotes.constFind(tickerSymbol.toUpper());
+                if (quote != quotes.constEnd())
+                    emit quoteReceived(tickerSymbol, quote.value());
+                else
+                    emit queryFailed(tickerSymbol, error.isEmpty() ? "No quote in bulk response" : error);
+            }
+        });
+    }
+
+    void sendQuery(const QString& tickerSymbol, bool tailOnly)
+    {
+        QueryBuilder queryBuilder = QueryBuilder::create()
+            .setAnalyticsUrl(sourceUrl)
+            .setFunction(function)
+            .setTickerSymbol(tickerSymbol)
+            .setOutputSize(tailOnly ? "compact" : "full")
+            .setApiKey(apiKey);
+        QString query = queryBuilder.build();
+
+        // Qt advertises gzip/deflate and inflates transparently as long as
+        // Accept-Encoding is left unset; connections to the host are pooled
+        // and kept alive across the per-ticker requests.
+        QNetworkRequest request{ QUrl{query} };
+        request.setRawHeader("Connection", "keep-alive");
+        request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+        QNetworkReply* reply = networkManager->get(request);
+        emit querySent(reply, tickerSymbol);
+    }
+
+    QNetworkAccessManager* networkManager = nullptr;
     QString apiKey;
     QString sourceUrl;
     QString function;
+    QString configurationError;
+    QString bulkFunction;
+    QString bulkDataType;
+    int maxBatchSize = 100;
+
+    struct PendingQuery
+    {
+        QString tickerSymbol;
+        bool tailOnly;
+        QStringList batch;           // symbols of a bulk quote request; empty for a single query
+    };
+
+    QStringList pendingQuotes;
+    QTimer batchTimer;
+
+    QQueue<PendingQuery> pendingQueries;
+    int inFlight = 0;
+    int maxInFlight = 8;
 };
 
 #endif // DATAFETCHER_HPP
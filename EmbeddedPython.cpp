@@ -0,0 +1,274 @@
+// Python.h must come before Qt, which defines `slots` as a macro
+#pragma push_macro("slots")
+#undef slots
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#pragma pop_macro("slots")
+
+#include <QDebug>
+#include <QDir>
+
+#include "EmbeddedPython.hpp"
+
+namespace
+{
+
+// Runs a script the way `python script.py args...` would, against the
+// zero-copy column buffers installed on the stockview module.
+const char* bootstrapSource = R"PY(
+import io
+import runpy
+import site
+import sys
+import traceback
+import types
+
+stockview = sys.modules.setdefault("stockview", types.ModuleType("stockview"))
+
+def run(script, argv, site_dirs, symbol, buffers):
+    for directory in site_dirs:
+        site.addsitedir(directory)
+
+    stockview.symbol = symbol
+    try:
+        import numpy
+        for name, view in buffers.items():
+            setattr(stockview, name, numpy.frombuffer(view, dtype=numpy.float64))
+    except ImportError:
+        for name, view in buffers.items():
+            setattr(stockview, name, view.cast("d"))
+
+    output = io.StringIO()
+    saved = sys.argv, sys.stdout, sys.stderr
+    sys.argv = [script] + list(argv)
+    sys.stdout = sys.stderr = output
+    code = 0
+    try:
+        runpy.run_path(script, run_name="__main__")
+    except SystemExit as exit:
+        if exit.code is None:
+            code = 0
+        elif isinstance(exit.code, int):
+            code = exit.code
+        else:
+            print(exit.code)
+            code = 1
+    except BaseException:
+        traceback.print_exc()
+        code = 1
+    finally:
+        sys.argv, sys.stdout, sys.stderr = saved
+
+    for name in buffers:
+        setattr(stockview, name, None)
+
+    # A buffer the script kept alive cannot be released; the host then keeps the series alive
+    released = True
+    for view in buffers.values():
+        try:
+            view.release()
+        except BufferError:
+            released = False
+
+    return code, output.getvalue(), released
+)PY";
+
+PyObject* makeBuffer(const double* data, int length)
+{
+    return PyMemoryView_FromMemory(reinterpret_cast<char*>(const_cast<double*>(data)),
+                                   static_cast<Py_ssize_t>(length) * static_cast<Py_ssize_t>(sizeof(double)),
+                                   PyBUF_READ);
+}
+
+QStringList sitePackages(const QString& environmentPath)
+{
+    QStringList result;
+    if (environmentPath.isEmpty())
+        return result;
+
+    QDir environment(environmentPath);
+#if defined(Q_OS_WIN)
+    if (environment.exists("Lib/site-packages"))
+        result << environment.filePath("Lib/site-packages");
+#else
+    const QStringList versions = QDir(environment.filePath("lib")).entryList({ "python*" }, QDir::Dirs);
+    for (const QString& version : versions)
+        result << environment.filePath("lib/" + version + "/site-packages");
+#endif
+    return result;
+}
+
+PyObject* toPythonList(const QStringList& strings)
+{
+    PyObject* list = PyList_New(strings.size());
+    for (int i = 0; i < strings.size(); ++i)
+        PyList_SET_ITEM(list, i, PyUnicode_FromString(strings.at(i).toUtf8().constData()));
+    return list;
+}
+
+QString fetchErrorText()
+{
+    PyObject* type = nullptr;
+    PyObject* value = nullptr;
+    PyObject* traceback = nullptr;
+    PyErr_Fetch(&type, &value, &traceback);
+
+    QString text = QStringLiteral("Embedded Python error");
+    if (value)
+    {
+        if (PyObject* string = PyObject_Str(value))
+        {
+            text += QStringLiteral(": ") + QString::fromUtf8(PyUnicode_AsUTF8(string));
+            Py_DECREF(string);
+        }
+    }
+
+    Py_XDECREF(type);
+    Py_XDECREF(value);
+    Py_XDECREF(traceback);
+    return text;
+}
+
+}
+
+namespace sv
+{
+
+EmbeddedPython::EmbeddedPython()
+    : thread(&EmbeddedPython::threadMain, this)
+{
+}
+
+EmbeddedPython::~EmbeddedPython()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_one();
+    thread.join();
+}
+
+std::future<EmbeddedPython::Result> EmbeddedPython::submit(const QString& filePath, const QStringList& arguments,
+                                                           const SeriesPtr& series, const QString& environmentPath)
+{
+    Job job;
+    job.filePath = filePath;
+    job.arguments = arguments;
+    job.series = series;
+    job.environmentPath = environmentPath;
+    std::future<Result> future = job.promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    condition.notify_one();
+
+    return future;
+}
+
+void EmbeddedPython::threadMain()
+{
+    // The interpreter is created, used and finalized on this thread only, so
+    // the GIL is simply held for the thread's lifetime.
+    Py_InitializeEx(0);
+
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+                break;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        job.promise.set_value(execute(job));
+    }
+
+    Py_FinalizeEx();
+}
+
+EmbeddedPython::Result EmbeddedPython::execute(Job& job)
+{
+    static PyObject* runFunction = nullptr;
+
+    Result result;
+
+    if (runFunction == nullptr)
+    {
+        PyObject* globals = PyDict_New();
+        PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+        PyObject* executed = PyRun_String(bootstrapSource, Py_file_input, globals, globals);
+        if (executed == nullptr)
+        {
+            result.exitCode = -1;
+            result.output = fetchErrorText();
+            Py_DECREF(globals);
+            return result;
+        }
+        Py_DECREF(executed);
+
+        runFunction = PyDict_GetItemString(globals, "run");
+        Py_XINCREF(runFunction);
+        Py_DECREF(globals);
+    }
+
+    const Series empty;
+    const Series& series = job.series.isNull() ? empty : *job.series;
+
+    PyObject* buffers = PyDict_New();
+    const char* names[Series::ColumnCount] = { "time", "open", "high", "low", "close", "volume" };
+    for (int column = 0; column < Series::ColumnCount; ++column)
+    {
+        PyObject* view = makeBuffer(series.column(static_cast<Series::Column>(column)), series.size());
+        PyDict_SetItemString(buffers, names[column], view);
+        Py_DECREF(view);
+    }
+
+    PyObject* argv = toPythonList(job.arguments);
+    PyObject* siteDirs = toPythonList(sitePackages(job.environmentPath));
+
+    PyObject* value = PyObject_CallFunction(runFunction, "sOOsO",
+                                            job.filePath.toUtf8().constData(), argv, siteDirs,
+                                            series.getSymbol().toUtf8().constData(), buffers);
+    Py_DECREF(argv);
+    Py_DECREF(siteDirs);
+    Py_DECREF(buffers);
+
+    int released = 1;
+    if (value == nullptr)
+    {
+        result.exitCode = -1;
+        result.output = fetchErrorText();
+        released = 0;
+    }
+    else
+    {
+        const char* output = nullptr;
+        if (!PyArg_ParseTuple(value, "isp", &result.exitCode, &output, &released))
+        {
+            result.exitCode = -1;
+            result.output = fetchErrorText();
+            released = 0;
+        }
+        else
+        {
+            result.output = QString::fromUtf8(output);
+        }
+        Py_DECREF(value);
+    }
+
+    if (!released && !job.series.isNull())
+    {
+        qWarning() << "Embedded Python kept a reference to the" << series.getSymbol() << "buffers";
+        retainedSeries.append(job.series);
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef EMBEDDEDPYTHON_HPP
+#define EMBEDDEDPYTHON_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <QString>
+#include <QStringList>
+
+#include "Series.hpp"
+
+namespace sv
+{
+
+/**
+ * @brief An in-process CPython interpreter living on its own thread.
+ *
+ * Scripts are executed with runpy as if launched from the command line, with
+ * sys.argv set from the arguments and stdout/stderr captured. The input series
+ * is exposed without copying as the module `stockview` (symbol, time, open,
+ * high, low, close, volume); the columns are read-only numpy arrays when numpy
+ * is importable and memoryviews otherwise, and are only valid during the run.
+ */
+class EmbeddedPython
+{
+public:
+
+    struct Result
+    {
+        int exitCode = 0;
+        QString output;
+    };
+
+    static EmbeddedPython& instance()
+    {
+        static EmbeddedPython interpreter;
+        return interpreter;
+    }
+
+    /**
+     * @brief Queue a script on the interpreter thread.
+     * @param filePath        The Python script to run.
+     * @param arguments       Everything after the script name in sys.argv.
+     * @param series          Series exposed through the stockview module; may be null.
+     * @param environmentPath Optional virtual environment whose site-packages are added to sys.path.
+     */
+    std::future<Result> submit(const QString& filePath, const QStringList& arguments,
+                               const SeriesPtr& series, const QString& environmentPath = QString());
+
+    Result run(const QString& filePath, const QStringList& arguments,
+               const SeriesPtr& series, const QString& environmentPath = QString())
+    {
+        return submit(filePath, arguments, series, environmentPath).get();
+    }
+
+private:
+
+    struct Job
+    {
+        QString filePath;
+        QStringList arguments;
+        SeriesPtr series;
+        QString environmentPath;
+        std::promise<Result> promise;
+    };
+
+    EmbeddedPython();
+    ~EmbeddedPython();
+
+    void threadMain();
+    Result execute(Job& job);
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Job> jobs;
+    bool stopping = false;
+
+    // Series whose buffers were still referenced by Python after a run
+    QVector<SeriesPtr> retainedSeries;
+};
+
+}
+
+#endif // EMBEDDEDPYTHON_HPP
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cmath>
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+
+#include "HeatmapWidget.hpp"
+
+namespace
+{
+
+const int margin = 60;
+const int maxLabeledSize = 40;
+
+}
+
+HeatmapWidget::HeatmapWidget(QWidget* parent) : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMouseTracking(true);
+    setMinimumSize(300, 300);
+}
+
+void HeatmapWidget::setMatrix(const QStringList& labels, const QVector<double>& values)
+{
+    this->labels = labels;
+    this->values = values;
+
+    // Render one pixel per cell once; painting then only scales the cached image
+    const int n = labels.size();
+    image = QImage(std::max(n, 1), std::max(n, 1), QImage::Format_RGB32);
+    image.fill(Qt::white);
+    for (int i = 0; i < n; ++i)
+    {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(i));
+        for (int j = 0; j < n; ++j)
+            line[j] = colorFor(values.value(i * n + j));
+    }
+
+    update();
+}
+
+void HeatmapWidget::setTitle(const QString& title)
+{
+    this->title = title;
+    setWindowTitle(title);
+    update();
+}
+
+QRgb HeatmapWidget::colorFor(double value)
+{
+    // Diverging blue (-1) / white (0) / red (+1)
+    const double clamped = std::clamp(std::isnan(value) ? 0.0 : value, -1.0, 1.0);
+    const int fade = static_cast<int>(255 * (1 - std::abs(clamped)));
+    return clamped >= 0 ? qRgb(255, fade, fade) : qRgb(fade, fade, 255);
+}
+
+QRectF HeatmapWidget::matrixRect() const
+{
+    const double side = std::max(0, std::min(width(), height()) - 2 * margin);
+    return QRectF(margin, margin, side, side);
+}
+
+void HeatmapWidget::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::white);
+
+    QFont titleFont = painter.font();
+    titleFont.setPointSize(12);
+    titleFont.setBold(true);
+    painter.setFont(titleFont);
+    painter.drawText(rect(), Qt::AlignTop | Qt::AlignHCenter, title);
+
+    const int n = labels.size();
+    if (n == 0)
+        return;
+
+    const QRectF area = matrixRect();
+    painter.drawImage(area, image);
+    painter.setPen(Qt::black);
+    painter.drawRect(area);
+
+    if (n > maxLabeledSize)
+        return;
+
+    QFont labelFont = painter.font();
+    labelFont.setPointSize(8);
+    labelFont.setBold(false);
+    painter.setFont(labelFont);
+
+    const double cell = area.width() / n;
+    for (int i = 0; i < n; ++i)
+    {
+        const QRectF rowLabel(0, area.top() + i * cell, area.left() - 4, cell);
+        painter.drawText(rowLabel, Qt::AlignRight | Qt::AlignVCenter, labels[i]);
+
+        painter.save();
+        painter.translate(area.left() + (i + 0.5) * cell, area.top() - 4);
+        painter.rotate(-90);
+        painter.drawText(QPointF(0, 4), labels[i]);
+        painter.restore();
+    }
+}
+
+void HeatmapWidget::mouseMoveEvent(QMouseEvent* event)
+{
+    const int n = labels.size();
+    const QRectF area = matrixRect();
+    const QPointF position = event->pos();
+
+    if (n == 0 || !area.contains(position))
+    {
+        QToolTip::hideText();
+        return;
+    }
+
+    const int column = std::min(n - 1, static_cast<int>((position.x() - area.left()) / area.width() * n));
+    const int row = std::min(n - 1, static_cast<int>((position.y() - area.top()) / area.height() * n));
+    QToolTip::showText(event->globalPos(), QString("%1 / %2: %3")
+                       .arg(labels[row], labels[column]).arg(values.value(row * n + column), 0, 'f', 3), this);
+}
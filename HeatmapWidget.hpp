@@ -0,0 +1,36 @@
+#ifndef HEATMAPWIDGET_HPP
+#define HEATMAPWIDGET_HPP
+
+#include <QImage>
+#include <QStringList>
+#include <QVector>
+#include <QWidget>
+
+// Square matrix view, e.g. of pairwise correlations in [-1, 1]
+class HeatmapWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+
+    explicit HeatmapWidget(QWidget* parent = nullptr);
+
+    void setMatrix(const QStringList& labels, const QVector<double>& values);
+    void setTitle(const QString& title);
+
+protected:
+
+    void paintEvent(QPaintEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+
+private:
+    static QRgb colorFor(double value);
+    QRectF matrixRect() const;
+
+    QStringList labels;
+    QVector<double> values;
+    QImage image;
+    QString title;
+};
+
+#endif // HEATMAPWIDGET_HPP
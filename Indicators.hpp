@@ -0,0 +1,365 @@
+#ifndef INDICATORS_HPP
+#define INDICATORS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "Series.hpp"
+
+namespace sv
+{
+
+// Incremental technical indicators. Each one is fed a single value per bar
+// and updates in O(1), so they can run inside backtests and on live bars. The
+// moving average and RSI also revise a still-forming bar (an intraday quote)
+// with replaceLast().
+
+// Fixed-size ring of the most recent values
+class RollingWindow
+{
+public:
+    explicit RollingWindow(int length)
+        : values(length > 0 ? length : 1)
+    {
+    }
+
+    // Push a value and return the one that fell out of the window (NaN while filling)
+    double push(double value)
+    {
+        double dropped = std::numeric_limits<double>::quiet_NaN();
+        if (count == values.size())
+            dropped = values[head];
+        else
+            ++count;
+
+        values[head] = value;
+        head = (head + 1) % values.size();
+        return dropped;
+    }
+
+    // Overwrite the latest value and return the one it replaced; the window must not be empty
+    double replaceLatest(double value)
+    {
+        double& latest = values[(head - 1 + values.size()) % values.size()];
+        const double replaced = latest;
+        latest = value;
+        return replaced;
+    }
+
+    bool isFull() const
+    {
+        return count == values.size();
+    }
+
+    int size() const
+    {
+        return count;
+    }
+
+    int capacity() const
+    {
+        return values.size();
+    }
+
+    // Value pushed `age` bars ago; age 0 is the latest
+    double ago(int age) const
+    {
+        return values[(head - 1 - age + 2 * values.size()) % values.size()];
+    }
+
+    void reset()
+    {
+        head = 0;
+        count = 0;
+    }
+
+private:
+    QVector<double> values;
+    int head = 0;
+    int count = 0;
+};
+
+class SimpleMovingAverage
+{
+public:
+    explicit SimpleMovingAverage(int period)
+        : window(period)
+    {
+    }
+
+    void push(double value)
+    {
+        const double dropped = window.push(value);
+        sum += value;
+        if (!std::isnan(dropped))
+            sum -= dropped;
+    }
+
+    void replaceLast(double value)
+    {
+        if (window.size() == 0)
+            push(value);
+        else
+            sum += value - window.replaceLatest(value);
+    }
+
+    bool isReady() const
+    {
+        return window.isFull();
+    }
+
+    double value() const
+    {
+        return isReady() ? sum / window.capacity() : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    void reset()
+    {
+        window.reset();
+        sum = 0;
+    }
+
+private:
+    RollingWindow window;
+    double sum = 0;
+};
+
+class ExponentialMovingAverage
+{
+public:
+    explicit ExponentialMovingAverage(int period)
+        : alpha(2.0 / (period + 1)), period(period)
+    {
+    }
+
+    void push(double value)
+    {
+        current = count == 0 ? value : current + alpha * (value - current);
+        ++count;
+    }
+
+    bool isReady() const
+    {
+        return count >= period;
+    }
+
+    double value() const
+    {
+        return isReady() ? current : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    void reset()
+    {
+        count = 0;
+        current = 0;
+    }
+
+private:
+    double alpha;
+    int period;
+    int count = 0;
+    double current = 0;
+};
+
+// RSI over simple returns with rolling-mean gains and losses, as computed in SimpleAnalysis.py
+class RelativeStrengthIndex
+{
+public:
+    explicit RelativeStrengthIndex(int period)
+        : gains(period), losses(period)
+    {
+    }
+
+    void push(double close)
+    {
+        lastChanged = hasPrevious && previous != 0;
+        if (lastChanged)
+        {
+            const double change = close / previous - 1;
+            gains.push(change > 0 ? change : 0);
+            losses.push(change < 0 ? -change : 0);
+        }
+        beforePrevious = previous;
+        previous = close;
+        hasPrevious = true;
+    }
+
+    void replaceLast(double close)
+    {
+        if (!hasPrevious)
+        {
+            push(close);
+            return;
+        }
+        if (lastChanged)
+        {
+            const double change = close / beforePrevious - 1;
+            gains.replaceLast(change > 0 ? change : 0);
+            losses.replaceLast(change < 0 ? -change : 0);
+        }
+        previous = close;
+    }
+
+    bool isReady() const
+    {
+        return gains.isReady();
+    }
+
+    double value() const
+    {
+        if (!isReady())
+            return std::numeric_limits<double>::quiet_NaN();
+        const double loss = losses.value();
+        return loss == 0 ? 100 : 100 - 100 / (1 + gains.value() / loss);
+    }
+
+    void reset()
+    {
+        gains.reset();
+        losses.reset();
+        hasPrevious = false;
+        lastChanged = false;
+    }
+
+private:
+    SimpleMovingAverage gains;
+    SimpleMovingAverage losses;
+    double previous = 0;
+    double beforePrevious = 0;
+    bool hasPrevious = false;
+    bool lastChanged = false;        // the latest close pushed a change
+};
+
+// Fractional change of the value over the last `period` bars
+class PercentChange
+{
+public:
+    explicit PercentChange(int period)
+        : window(period + 1)
+    {
+    }
+
+    void push(double value)
+    {
+        window.push(value);
+    }
+
+    bool isReady() const
+    {
+        return window.isFull();
+    }
+
+    double value() const
+    {
+        if (!isReady())
+            return std::numeric_limits<double>::quiet_NaN();
+        const double base = window.ago(window.capacity() - 1);
+        return base == 0 ? std::numeric_limits<double>::quiet_NaN() : window.ago(0) / base - 1;
+    }
+
+    void reset()
+    {
+        window.reset();
+    }
+
+private:
+    RollingWindow window;
+};
+
+// The indicators shown alongside a series (those SimpleAnalysis.py reports),
+// fed one close at a time by both the fetch pipeline and replays
+class IndicatorSnapshot
+{
+public:
+    void push(double close)
+    {
+        last = close;
+        sma20.push(close);
+        sma50.push(close);
+        rsi14.push(close);
+    }
+
+    void replaceLast(double close)
+    {
+        last = close;
+        sma20.replaceLast(close);
+        sma50.replaceLast(close);
+        rsi14.replaceLast(close);
+    }
+
+    /**
+     * @brief Apply the bars of `series` newer than the last one seen; a changed
+     *        latest bar replaces it, a rewritten history starts over. Keeps
+     *        a snapshot per symbol current in O(1) per live quote. Do not mix
+     *        with push() on the same snapshot.
+     */
+    void update(const Series& series)
+    {
+        if (series.isEmpty())
+            return;
+
+        const int n = series.size();
+        const double* time = series.column(Series::Time);
+        const double* close = series.column(Series::Close);
+
+        if (bars > 0 && (time[0] != firstTime || time[n - 1] < lastTime))
+            reset();
+
+        // From the last bar seen, so a revised latest bar replaces it
+        const int start = bars > 0 ? static_cast<int>(std::lower_bound(time, time + n, lastTime) - time) : 0;
+        for (int i = start; i < n; ++i)
+        {
+            if (bars > 0 && time[i] == lastTime)
+            {
+                if (close[i] != last)
+                    replaceLast(close[i]);
+                continue;
+            }
+
+            if (bars == 0)
+                firstTime = time[i];
+            push(close[i]);
+            lastTime = time[i];
+            ++bars;
+        }
+    }
+
+    QMap<QString, double> values() const
+    {
+        return {
+            {"Close", last},
+            {"SMA 20", sma20.value()},
+            {"SMA 50", sma50.value()},
+            {"RSI 14", rsi14.value()}
+        };
+    }
+
+    void reset()
+    {
+        last = std::numeric_limits<double>::quiet_NaN();
+        sma20.reset();
+        sma50.reset();
+        rsi14.reset();
+        bars = 0;
+        firstTime = 0;
+        lastTime = 0;
+    }
+
+private:
+    double last = std::numeric_limits<double>::quiet_NaN();
+    int bars = 0;                    // bars applied by update()
+    double firstTime = 0;
+    double lastTime = 0;
+    SimpleMovingAverage sma20{20};
+    SimpleMovingAverage sma50{50};
+    RelativeStrengthIndex rsi14{14};
+};
+
+}
+
+#endif // INDICATORS_HPP
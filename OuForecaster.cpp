@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cmath>
+
+#include "OuForecaster.hpp"
+
+namespace sv
+{
+
+OuForecaster::OuForecaster(int horizon, double tolerance)
+    : horizon(std::clamp(horizon, 1, window)),
+      tolerance(tolerance),
+      recentLogs(window),
+      recentTimes(window)
+{
+}
+
+void OuForecaster::setHorizon(int bars)
+{
+    horizon = std::clamp(bars, 1, window);
+    forecast = ForecastBand();
+    refresh();
+}
+
+void OuForecaster::reset()
+{
+    bars = 0;
+    firstTime = 0;
+    lastClose = 0;
+    sumR = sumR2 = 0;
+    sumX = sumY = sumXX = sumYY = sumXY = 0;
+    forecast = ForecastBand();
+    rebuilds = 0;
+}
+
+double OuForecaster::logAt(int bar) const
+{
+    return recentLogs[bar % window];
+}
+
+double OuForecaster::timeAt(int bar) const
+{
+    return recentTimes[bar % window];
+}
+
+void OuForecaster::accumulate(int bar, double sign)
+{
+    if (bar < 1)
+        return;
+
+    const double current = logAt(bar) - logAt(bar - 1);
+    sumR += sign * current;
+    sumR2 += sign * current * current;
+    if (bar < 2)
+        return;
+
+    const double previous = logAt(bar - 1) - logAt(bar - 2);
+    sumX += sign * previous;
+    sumY += sign * current;
+    sumXX += sign * previous * previous;
+    sumYY += sign * current * current;
+    sumXY += sign * previous * current;
+}
+
+void OuForecaster::push(double time, double close)
+{
+    if (bars == 0)
+        firstTime = time;
+
+    recentLogs[bars % window] = std::log(close);
+    recentTimes[bars % window] = time;
+    accumulate(bars, 1);
+    ++bars;
+    lastClose = close;
+}
+
+void OuForecaster::replaceLast(double close)
+{
+    // Take out the last bar's return and pair, then put them back revised
+    accumulate(bars - 1, -1);
+    recentLogs[(bars - 1) % window] = std::log(close);
+    accumulate(bars - 1, 1);
+    lastClose = close;
+}
+
+bool OuForecaster::append(double time, double close)
+{
+    if (!(close > 0) || !std::isfinite(close))
+        return false;
+
+    if (bars > 0 && time <= timeAt(bars - 1))
+    {
+        if (time < timeAt(bars - 1) || close == lastClose)
+            return false;
+        replaceLast(close);
+    }
+    else
+    {
+        push(time, close);
+    }
+    return refresh();
+}
+
+bool OuForecaster::update(const Series& series)
+{
+    if (series.isEmpty())
+        return false;
+
+    const int n = series.size();
+    const double* time = series.column(Series::Time);
+    const double* close = series.column(Series::Close);
+
+    if (bars > 0 && (time[0] != firstTime || time[n - 1] < timeAt(bars - 1)))
+        reset();
+
+    // From the last bar seen, so a revised latest bar replaces it
+    const int first = bars > 0 ? static_cast<int>(std::lower_bound(time, time + n, timeAt(bars - 1)) - time) : 0;
+    for (int i = first; i < n; ++i)
+    {
+        if (!(close[i] > 0) || !std::isfinite(close[i]))
+            continue;
+
+        if (bars > 0 && time[i] == timeAt(bars - 1))
+        {
+            if (close[i] != lastClose)
+                replaceLast(close[i]);
+        }
+        else if (bars == 0 || time[i] > timeAt(bars - 1))
+        {
+            push(time[i], close[i]);
+        }
+    }
+    return refresh();
+}
+
+OuParameters OuForecaster::parameters() const
+{
+    OuParameters result;
+    if (bars < 4)
+        return result;
+
+    const double returns = bars - 1;
+    const double meanReturn = sumR / returns;
+    const double empiricalSigma = std::sqrt(std::max(0.0, sumR2 / returns - meanReturn * meanReturn));
+
+    const double pairs = bars - 2;
+    const double covariance = pairs * sumXY - sumX * sumY;
+    const double variance = (pairs * sumXX - sumX * sumX) * (pairs * sumYY - sumY * sumY);
+    const double correlation = variance > 0 ? covariance / std::sqrt(variance) : 0;
+    result.theta = std::clamp(-std::log(std::abs(correlation)), 0.1, 10.0);
+
+    // Weights below 1e-17 of the newest cannot change the mean
+    const int span = std::min({ bars, window, static_cast<int>(std::ceil(40 / result.theta)) + 1 });
+    const double decay = std::exp(-result.theta);
+    double weight = 1;
+    double weighted = 0;
+    double total = 0;
+    for (int age = 0; age < span; ++age)
+    {
+        weighted += weight * logAt(bars - 1 - age);
+        total += weight;
+        weight *= decay;
+    }
+    result.mu = weighted / total;
+
+    result.sigma = std::min(empiricalSigma * std::sqrt(2 * result.theta / (1 - std::exp(-2 * result.theta))), 0.5);
+
+    const int trendBars = std::min(20, bars);
+    result.trend = (logAt(bars - 1) - logAt(bars - trendBars)) / (trendBars - 1);
+    return result;
+}
+
+bool OuForecaster::refresh()
+{
+    if (bars < 4)
+    {
+        forecast = ForecastBand();
+        return false;
+    }
+
+    const OuParameters current = parameters();
+    if (!needsRebuild(current))
+        return false;
+
+    rebuild(current);
+    ++rebuilds;
+    return true;
+}
+
+bool OuForecaster::needsRebuild(const OuParameters& current) const
+{
+    if (forecast.isEmpty())
+        return true;
+
+    const OuParameters& built = forecast.parameters;
+    if (std::abs(current.theta - built.theta) > tolerance * built.theta
+        || std::abs(current.sigma - built.sigma) > tolerance * built.sigma
+        || std::abs(current.mu - built.mu) > tolerance * built.sigma
+        || std::abs(current.trend - built.trend) > tolerance * built.sigma)
+        return true;
+
+    const int step = bars - forecast.originBar;
+    if (2 * step >= horizon)
+        return true;
+
+    return step >= 1 && (lastClose < forecast.lower[step].y() || lastClose > forecast.upper[step].y());
+}
+
+void OuForecaster::project(const OuParameters& parameters, double origin, int step, double& mean, double& deviation)
+{
+    // dx = theta (mu - x) + trend reverts to mu + trend / theta
+    const double level = parameters.mu + parameters.trend / parameters.theta;
+    const double decay = std::exp(-parameters.theta * step);
+    mean = level + (origin - level) * decay;
+    deviation = parameters.sigma * std::sqrt((1 - decay * decay) / (2 * parameters.theta));
+}
+
+void OuForecaster::rebuild(const OuParameters& current)
+{
+    forecast = ForecastBand();
+    forecast.parameters = current;
+    forecast.originBar = bars;
+    bandOrigin = logAt(bars - 1);
+
+    const double originTime = timeAt(bars - 1);
+    const int span = std::min(bars, window);
+    const double spacing = (originTime - timeAt(bars - span)) / (span - 1);
+    const double floor = lastClose * 0.5;
+    const double ceiling = lastClose * 2.0;
+
+    forecast.expected.reserve(horizon + 1);
+    forecast.lower.reserve(horizon + 1);
+    forecast.upper.reserve(horizon + 1);
+    for (int step = 0; step <= horizon; ++step)
+    {
+        double mean;
+        double deviation;
+        project(current, bandOrigin, step, mean, deviation);
+        const double time = originTime + step * spacing;
+
+        forecast.expected.append(QPointF(time, std::clamp(std::exp(mean), floor, ceiling)));
+        forecast.lower.append(QPointF(time, std::clamp(std::exp(mean - 1.96 * deviation), floor, ceiling)));
+        forecast.upper.append(QPointF(time, std::clamp(std::exp(mean + 1.96 * deviation), floor, ceiling)));
+    }
+}
+
+}
@@ -0,0 +1,134 @@
+#ifndef OUFORECASTER_HPP
+#define OUFORECASTER_HPP
+
+#include <QPointF>
+#include <QVector>
+
+#include "Series.hpp"
+
+namespace sv
+{
+
+// Model of the log price, in units of bars
+struct OuParameters
+{
+    double theta = 0;                // mean reversion speed per bar
+    double mu = 0;                   // long-term mean of the log price
+    double sigma = 0;                // volatility per square-root bar
+    double trend = 0;                // mean log return over the last 20 bars
+};
+
+struct ForecastBand
+{
+    OuParameters parameters;
+    int originBar = 0;               // bars seen when the band was built
+    QVector<QPointF> expected;       // origin then one point per projected bar
+    QVector<QPointF> lower;          // 95% band
+    QVector<QPointF> upper;
+
+    bool isEmpty() const
+    {
+        return expected.isEmpty();
+    }
+};
+
+/**
+ * @brief Incremental Ornstein-Uhlenbeck forecast of a price series.
+ *
+ * The model is the one stock-predictor.py fits: theta from the lag-one
+ * autocorrelation of log returns, mu as a mean of log prices weighted by
+ * exp(-theta * age), sigma from the return variance, and the recent trend.
+ * Running sums of returns, squared returns and return pairs make each new
+ * bar O(1); mu needs only the recent log prices, since theta is at least 0.1
+ * per bar and older weights vanish. A revised latest bar (e.g. an intraday
+ * quote) replaces the previous one by subtracting its terms.
+ *
+ * The band is the expected path and 95% range of the fitted process. It is
+ * rebuilt only when a parameter moves past the tolerance, the latest close
+ * leaves the band, or half the horizon has elapsed; otherwise appending a bar
+ * does not touch it.
+ */
+class OuForecaster
+{
+public:
+    explicit OuForecaster(int horizon = 30, double tolerance = 0.5);
+
+    void setHorizon(int bars);
+
+    // Relative change in theta or sigma, or change in mu or the trend in units
+    // of sigma, that triggers a rebuild
+    void setTolerance(double tolerance)
+    {
+        this->tolerance = tolerance;
+    }
+
+    void reset();
+
+    /**
+     * @brief Apply the bars of `series` newer than the last one seen; a
+     *        changed latest bar replaces it, a rewritten history starts over.
+     * @return True if the band was rebuilt.
+     */
+    bool update(const Series& series);
+
+    bool append(double time, double close);
+
+    // Computed from the running statistics; zero until there are four bars
+    OuParameters parameters() const;
+
+    const ForecastBand& band() const
+    {
+        return forecast;
+    }
+
+    int barCount() const
+    {
+        return bars;
+    }
+
+    int getRebuildCount() const
+    {
+        return rebuilds;
+    }
+
+private:
+    // Recent log prices kept for mu, the trend and the bar spacing
+    static constexpr int window = 512;
+
+    void push(double time, double close);
+    void replaceLast(double close);
+    // Add (sign 1) or remove (sign -1) the return ending at `bar` and its pair
+    void accumulate(int bar, double sign);
+    double logAt(int bar) const;
+    double timeAt(int bar) const;
+    bool refresh();
+    bool needsRebuild(const OuParameters& current) const;
+    static void project(const OuParameters& parameters, double origin, int step, double& mean, double& deviation);
+    void rebuild(const OuParameters& current);
+
+    int horizon;
+    double tolerance;
+
+    int bars = 0;
+    double firstTime = 0;
+    double lastClose = 0;
+    QVector<double> recentLogs;
+    QVector<double> recentTimes;
+
+    // Sums over returns r, and over consecutive pairs (x, y) = (r[t-1], r[t])
+    double sumR = 0;
+    double sumR2 = 0;
+    double sumX = 0;
+    double sumY = 0;
+    double sumXX = 0;
+    double sumYY = 0;
+    double sumXY = 0;
+
+    ForecastBand forecast;
+    double bandOrigin = 0;           // log close the band starts from
+    int rebuilds = 0;
+};
+
+}
+
+#endif // OUFORECASTER_HPP
@@ -0,0 +1,274 @@
+#ifndef PLUGINHOST_HPP
+#define PLUGINHOST_HPP
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QLibrary>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include "QtUtils.hpp"
+#include "Series.hpp"
+#include "StockViewPlugin.h"
+
+class PluginHost : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit PluginHost(QObject* parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+    ~PluginHost()
+    {
+        unloadAll();
+    }
+
+    /**
+     * @brief Whether the given path names a shared library that could be a plugin.
+     */
+    static bool isPlugin(const QString& filePath)
+    {
+        return QLibrary::isLibrary(filePath);
+    }
+
+    /**
+     * @brief List every Python script and plugin library found directly in the
+     *        given directories.
+     */
+    static QStringList discover(const QStringList& directories)
+    {
+        QStringList result;
+
+        for (const QString& directory : directories)
+        {
+            QDir dir(directory);
+            if (!dir.exists())
+                continue;
+
+            const QFileInfoList entries = dir.entryInfoList(QDir::Files, QDir::Name);
+            for (const QFileInfo& entry : entries)
+            {
+                if (entry.suffix() == QLatin1String("py") || isPlugin(entry.fileName()))
+                    result << entry.absoluteFilePath();
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Unload every plugin so that the next run picks up a fresh build.
+     */
+    void reloadAll()
+    {
+        unloadAll();
+    }
+
+    /**
+     * @brief Run a plugin over the given series. The plugin is (re)loaded if it
+     *        has not been loaded yet or the file changed since the last load.
+     * @param filePath  The plugin library.
+     * @param series    The series exposed to the plugin.
+     * @param arguments Arguments passed through as argv.
+     *
+     * @return The emitted series, metrics and annotations plus any printed text.
+     */
+    sv::AnalysisResult run(const QString& filePath, const sv::SeriesPtr& series, const QStringList& arguments)
+    {
+        sv::AnalysisResult result;
+
+        QString error;
+        const LoadedPlugin* plugin = load(filePath, &error);
+        if (plugin == nullptr)
+        {
+            result.exitCode = -1;
+            result.output = error;
+            return result;
+        }
+
+        const sv::Series empty;
+        const sv::Series& data = series.isNull() ? empty : *series;
+        const QByteArray symbol = data.getSymbol().toUtf8();
+
+        sv_series_view view;
+        view.symbol = symbol.constData();
+        view.length = static_cast<size_t>(data.size());
+        view.time = data.column(sv::Series::Time);
+        view.open = data.column(sv::Series::Open);
+        view.high = data.column(sv::Series::High);
+        view.low = data.column(sv::Series::Low);
+        view.close = data.column(sv::Series::Close);
+        view.volume = data.column(sv::Series::Volume);
+
+        QList<QByteArray> encodedArguments;
+        QVector<const char*> argv;
+        for (const QString& argument : arguments)
+            encodedArguments << argument.toUtf8();
+        for (const QByteArray& argument : encodedArguments)
+            argv << argument.constData();
+
+        EmitContext context{ &result, data.getSymbol() };
+
+        sv_host host;
+        host.context = &context;
+        host.emit_series = &PluginHost::emitSeries;
+        host.emit_metric = &PluginHost::emitMetric;
+        host.emit_annotation = &PluginHost::emitAnnotation;
+        host.print = &PluginHost::print;
+
+        result.exitCode = plugin->run(&view, argv.size(), argv.constData(), &host);
+
+        return result;
+    }
+
+    /**
+     * @brief Human readable name of a plugin, or the file name if it cannot be loaded.
+     */
+    QString pluginName(const QString& filePath)
+    {
+        const LoadedPlugin* plugin = load(filePath, nullptr);
+        if (plugin == nullptr || plugin->info == nullptr || plugin->info->name == nullptr)
+            return QFileInfo(filePath).fileName();
+        return QString::fromUtf8(plugin->info->name);
+    }
+
+private:
+
+    struct LoadedPlugin
+    {
+        QSharedPointer<QLibrary> library;
+        QDateTime lastModified;
+        QString shadowPath;
+        const sv_plugin_info* info = nullptr;
+        sv_plugin_run_fn run = nullptr;
+    };
+
+    struct EmitContext
+    {
+        sv::AnalysisResult* result;
+        QString symbol;
+    };
+
+    const LoadedPlugin* load(const QString& filePath, QString* error)
+    {
+        const QFileInfo fileInfo(filePath);
+        const QString key = fileInfo.absoluteFilePath();
+
+        auto it = plugins.find(key);
+        if (it != plugins.end())
+        {
+            if (it->lastModified == fileInfo.lastModified())
+                return &it.value();
+
+            qDebug() << "Plugin changed on disk, reloading:" << key;
+            unload(it.value());
+            plugins.erase(it);
+        }
+
+        // Load from a shadow copy so the original can be rebuilt while StockView runs
+        const QByteArray pathHash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex().left(8);
+        const QString shadowPath = QDir::temp().filePath(
+            QString("StockView-plugin-%1-%2.%3").arg(QString::fromLatin1(pathHash))
+                .arg(fileInfo.lastModified().toMSecsSinceEpoch()).arg(fileInfo.suffix()));
+
+        QFile::remove(shadowPath);
+        if (!QFile::copy(key, shadowPath))
+        {
+            if (error)
+                *error = QString("Failed to copy plugin %1").arg(key);
+            return nullptr;
+        }
+
+        LoadedPlugin plugin;
+        plugin.library = QSharedPointer<QLibrary>::create(shadowPath);
+        plugin.lastModified = fileInfo.lastModified();
+        plugin.shadowPath = shadowPath;
+
+        if (!plugin.library->load())
+        {
+            if (error)
+                *error = QString("Failed to load plugin %1: %2").arg(key, plugin.library->errorString());
+            QFile::remove(shadowPath);
+            return nullptr;
+        }
+
+        auto getInfo = reinterpret_cast<sv_plugin_get_info_fn>(plugin.library->resolve("sv_plugin_get_info"));
+        plugin.run = reinterpret_cast<sv_plugin_run_fn>(plugin.library->resolve("sv_plugin_run"));
+        plugin.info = getInfo ? getInfo() : nullptr;
+
+        if (plugin.run == nullptr || plugin.info == nullptr || plugin.info->api_version != SV_PLUGIN_API_VERSION)
+        {
+            if (error)
+                *error = QString("%1 is not a StockView plugin (API version %2 required)")
+                             .arg(key).arg(SV_PLUGIN_API_VERSION);
+            unload(plugin);
+            return nullptr;
+        }
+
+        return &plugins.insert(key, plugin).value();
+    }
+
+    static void unload(LoadedPlugin& plugin)
+    {
+        plugin.library->unload();
+        QFile::remove(plugin.shadowPath);
+    }
+
+    void unloadAll()
+    {
+        for (LoadedPlugin& plugin : plugins)
+            unload(plugin);
+        plugins.clear();
+    }
+
+    static void emitSeries(void* context, const char* name, const double* time, const double* values, size_t length)
+    {
+        auto* emitContext = static_cast<EmitContext*>(context);
+        const QString seriesName = QString::fromUtf8(name);
+
+        QVector<QPointF> points;
+        points.reserve(static_cast<int>(length));
+        for (size_t i = 0; i < length; ++i)
+            points.append(QPointF(time[i], values[i]));
+
+        sv::StockDataResult series;
+        series.points = points;
+        series.labels = {
+            {"x_axis", "Date"},
+            {"y_axis", "Price (USD)"},
+            {"legend", seriesName},
+            {"title", emitContext->symbol + " Daily Stock Prices"}
+        };
+        emitContext->result->series.append(series);
+    }
+
+    static void emitMetric(void* context, const char* name, double value)
+    {
+        static_cast<EmitContext*>(context)->result->metrics.insert(QString::fromUtf8(name), value);
+    }
+
+    static void emitAnnotation(void* context, double time, const char* text)
+    {
+        static_cast<EmitContext*>(context)->result->annotations.append(sv::Annotation{ time, QString::fromUtf8(text) });
+    }
+
+    static void print(void* context, const char* text)
+    {
+        static_cast<EmitContext*>(context)->result->output += QString::fromUtf8(text);
+    }
+
+    QHash<QString, LoadedPlugin> plugins;
+};
+
+#endif // PLUGINHOST_HPP
@@ -1,6 +1,9 @@
 #ifndef PYTHONLAUNCHER_HPP
 #define PYTHONLAUNCHER_HPP
 
+#include <atomic>
+#include <mutex>
+
 #include <QString>
 #include <QMessageBox>
 #include <QProcess>
@@ -12,6 +15,12 @@
 #include <QFile>
 #include <QTextStream>
 
+#include "Series.hpp"
+
+#ifdef STOCKVIEW_EMBED_PYTHON
+#include "EmbeddedPython.hpp"
+#endif
+
 class PythonLauncher : public QObject
 {
     Q_OBJECT
@@ -25,6 +34,9 @@ public:
      */
     int run()
     {
+        if (embedded)
+            return runEmbedded();
+
         if (pythonExecutable.isEmpty())
             pythonExecutable = QStringLiteral("python");
 
@@ -53,18 +65,65 @@ public:
     }
 
     /**
-     * @brief Create a virtual environment in the given directory and optionally
-     *        install the specified Python modules.
-     * @param directory The directory where the new venv will be created.
+     * @brief Use a virtual environment in the given directory, creating it and
+     *        installing the specified Python modules if that has not been done yet.
+     * @param directory The directory of the venv.
      * @param modules   A list of modules to install via pip (e.g. {"numpy", "pandas"}).
      *
-     * @note Must be called before run().
+     * @note Must be called before run(), and after setEmbedded().
      */
     void addVirtualEnvironment(const QString& directory, const QList<QString>& modules = {})
     {
         if (directory.isEmpty())
             return;
 
+        // The embedded interpreter only borrows the environment's site-packages
+        if (embedded)
+        {
+            environmentPath = directory;
+            return;
+        }
+
+        pythonExecutable = provisionEnvironment(directory, modules);
+    }
+
+    /**
+     * @brief Create the venv and install the modules unless an earlier call
+     *        already did, as recorded by a stamp file in the environment. Blocks
+     *        while pip runs, so call it from a worker thread ahead of the first run.
+     * @param cancelled Once set, a running venv or pip process is killed and
+     *                  nothing is recorded, so the next call starts over.
+     * @return The environment's python executable, or an empty string if the
+     *         environment could not be created.
+     */
+    static QString provisionEnvironment(const QString& directory, const QList<QString>& modules = {},
+                                        const std::atomic<bool>* cancelled = nullptr)
+    {
+        // Counted before waiting for the lock, so a caller queued behind pip shows too
+        ++provisioningCount();
+        struct Done { ~Done() { --provisioningCount(); } } done;
+
+        static std::mutex provisioning;
+        std::lock_guard<std::mutex> lock(provisioning);
+
+#if defined(Q_OS_WIN)
+        const QString executable = QDir(directory).filePath("Scripts/python.exe");
+#else
+        const QString executable = QDir(directory).filePath("bin/python");
+#endif
+
+        QStringList sortedModules = modules;
+        sortedModules.sort();
+        const QString stamp = sortedModules.join('\n');
+        QFile stampFile(QDir(directory).filePath("stockview-modules.txt"));
+
+        if (QFileInfo::exists(executable) && stampFile.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            if (QString::fromUtf8(stampFile.readAll()) == stamp)
+                return executable;
+            stampFile.close();
+        }
+
         {
             QProcess venvProcess;
             QStringList args;
@@ -78,24 +137,19 @@ public:
             if (!venvProcess.waitForStarted())
             {
                 qWarning() << "Failed to start python -m venv process.";
-                return;
+                return QString();
             }
 
-            venvProcess.waitForFinished();
+            if (!waitUnlessCancelled(venvProcess, cancelled))
+                return QString();
 
             if (venvProcess.exitCode() != 0)
             {
                 qWarning() << "Creating virtual environment failed:" << venvProcess.readAll();
-                return;
+                return QString();
             }
         }
 
-#if defined(Q_OS_WIN)
-        pythonExecutable = QDir(directory).filePath("Scripts/python.exe");
-#else
-        pythonExecutable = QDir(directory).filePath("bin/python");
-#endif
-
         if (!modules.isEmpty())
         {
             QProcess installProcess;
@@ -107,22 +161,63 @@ public:
 
             installArgs << modules;
 
-            installProcess.start(pythonExecutable, installArgs);
+            installProcess.start(executable, installArgs);
 
             if (!installProcess.waitForStarted())
             {
                 qWarning() << "Failed to start pip install process.";
-                return;
+                return executable;
             }
 
-            installProcess.waitForFinished();
+            if (!waitUnlessCancelled(installProcess, cancelled))
+                return QString();
 
             if (installProcess.exitCode() != 0)
             {
                 qWarning() << "Installing modules failed:" << installProcess.readAll();
-                return;
+                return executable;
             }
         }
+
+        if (stampFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+            stampFile.write(stamp.toUtf8());
+
+        return executable;
+    }
+
+    /**
+     * @brief True while provisionEnvironment() is running on some thread; a
+     *        non-embedded run would block until it finishes.
+     */
+    static bool isProvisioning()
+    {
+        return provisioningCount() > 0;
+    }
+
+    /**
+     * @brief Run the script in the embedded interpreter instead of spawning a
+     *        python process. Only available when built with STOCKVIEW_EMBED_PYTHON.
+     */
+    void setEmbedded(bool embedded)
+    {
+        this->embedded = embedded;
+    }
+
+    /**
+     * @brief Series exposed to embedded runs through the stockview module.
+     */
+    void setInputSeries(const sv::SeriesPtr& series)
+    {
+        inputSeries = series;
+    }
+
+    static bool isEmbeddedAvailable()
+    {
+#ifdef STOCKVIEW_EMBED_PYTHON
+        return true;
+#else
+        return false;
+#endif
     }
 
     /**
@@ -157,11 +252,51 @@ private:
 
     PythonLauncher() = default;
 
+    static std::atomic<int>& provisioningCount()
+    {
+        static std::atomic<int> count{ 0 };
+        return count;
+    }
+
+    // Wait for the process to exit; false, with the process killed, if cancelled first
+    static bool waitUnlessCancelled(QProcess& process, const std::atomic<bool>* cancelled)
+    {
+        while (!process.waitForFinished(200))
+        {
+            if (process.state() == QProcess::NotRunning)
+                return true;
+            if (cancelled != nullptr && cancelled->load())
+            {
+                process.kill();
+                process.waitForFinished();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int runEmbedded()
+    {
+#ifdef STOCKVIEW_EMBED_PYTHON
+        const sv::EmbeddedPython::Result result =
+            sv::EmbeddedPython::instance().run(filePath, arguments, inputSeries, environmentPath);
+        outputString = result.output;
+        return result.exitCode;
+#else
+        outputString = QStringLiteral("Embedded Python support was not compiled in (STOCKVIEW_EMBED_PYTHON).");
+        return -1;
+#endif
+    }
+
     QString filePath;
     QList<QString> arguments;
     QString outputString;
 
     QString pythonExecutable;
+
+    bool embedded = false;
+    QString environmentPath;
+    sv::SeriesPtr inputSeries;
 };
 
 
@@ -6,6 +6,8 @@
 #include <QString>
 #include <QRegularExpression>
 
+#include "Series.hpp"
+
 namespace sv
 {
 
@@ -14,6 +16,24 @@ struct StockDataResult
 {
     QVector<QPointF> points;
     QMap<QString, QString> labels;
+    SeriesPtr series;
+};
+
+// A marker placed on the chart at a given timestamp
+struct Annotation
+{
+    double timestamp;
+    QString text;
+};
+
+// Everything an analysis (Python script or native plugin) hands back to the UI
+struct AnalysisResult
+{
+    int exitCode = 0;
+    QString output;
+    QVector<StockDataResult> series;
+    QMap<QString, double> metrics;
+    QVector<Annotation> annotations;
 };
 
 inline QString convertToWslPath(const QString& windowsPath)
@@ -37,6 +57,21 @@ inline QString convertToWslPath(const QString& windowsPath)
     return QString("/mnt/%1%2").arg(driveLetter, pathWithoutDrive);
 }
 
+// Split "key=value" arguments into a map; bare words map to an empty value
+inline QMap<QString, QString> parseKeyValueArguments(const QStringList& arguments)
+{
+    QMap<QString, QString> result;
+    for (const QString& argument : arguments)
+    {
+        const int index = argument.indexOf('=');
+        if (index > 0)
+            result.insert(argument.left(index).trimmed(), argument.mid(index + 1).trimmed());
+        else
+            result.insert(argument.trimmed(), QString());
+    }
+    return result;
+}
+
 inline QString findProjectRoot()
 {
     QDir dir(QCoreApplication::applicationDirPath());
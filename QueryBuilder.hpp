@@ -1,8 +1,12 @@
 #ifndef QUERYBUILDER_HPP
 #define QUERYBUILDER_HPP
 
-#include <QString>
 #include <QJsonDocument>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
 
 class QueryBuilder
 {
@@ -42,10 +46,38 @@ public:
         return *this;
     }
 
+    // For batch endpoints that take a comma-separated symbol list
+    QueryBuilder& setTickerSymbols(const QStringList& tickerSymbols)
+    {
+        this->tickerSymbol = tickerSymbols.join(',');
+        return *this;
+    }
+
+    // Any further query parameter, e.g. interval=5min or datatype=csv
+    QueryBuilder& addParameter(const QString& name, const QString& value)
+    {
+        parameters.append(qMakePair(name, value));
+        return *this;
+    }
+
+    // "compact" returns only the latest 100 bars, "full" the whole history
+    QueryBuilder& setOutputSize(const QString& outputSize)
+    {
+        this->outputSize = outputSize;
+        return *this;
+    }
+
     QString build() const
     {
         QString query = QString("%1/query?function=%2&symbol=%3&apikey=%4").arg(
             analyticsUrl, function, tickerSymbol, apiKey);
+        if (!outputSize.isEmpty())
+            query += QString("&outputsize=%1").arg(outputSize);
+        for (const auto& parameter : parameters)
+        {
+            query += QString("&%1=%2").arg(QString::fromUtf8(QUrl::toPercentEncoding(parameter.first)),
+                                           QString::fromUtf8(QUrl::toPercentEncoding(parameter.second)));
+        }
         return query;
     }
 
@@ -60,6 +92,8 @@ private:
     QString analyticsUrl;
     QString tickerSymbol;
     QString function;
+    QString outputSize;
+    QList<QPair<QString, QString>> parameters;
     QJsonDocument::JsonFormat jsonFormat;
 };
 
@@ -0,0 +1,198 @@
+#include <algorithm>
+
+#include <QTimeZone>
+
+#include "RefreshScheduler.hpp"
+
+namespace
+{
+
+const QTimeZone& exchangeZone()
+{
+    static const QTimeZone zone("America/New_York");
+    return zone;
+}
+
+const QTime sessionOpen(9, 30);
+const QTime sessionClose(16, 0);
+
+// Daily bars are published a little after the close
+const int publishDelaySeconds = 30 * 60;
+
+const int maximumBackoffSeconds = 30 * 60;
+
+bool isTradingDay(const QDate& date)
+{
+    return date.dayOfWeek() <= 5;
+}
+
+}
+
+RefreshScheduler::RefreshScheduler(QObject* parent)
+    : QObject(parent)
+{
+    connect(&timer, &QTimer::timeout, this, &RefreshScheduler::tick);
+    bucketClock.start();
+}
+
+void RefreshScheduler::setSymbols(const QStringList& symbols)
+{
+    this->symbols.clear();
+    for (const QString& symbol : symbols)
+    {
+        this->symbols.insert(symbol);
+        if (!entries.contains(symbol))
+            entries.insert(symbol, Entry());
+    }
+}
+
+void RefreshScheduler::setVisible(const QString& symbol)
+{
+    visibleSymbol = symbol;
+}
+
+void RefreshScheduler::markViewed(const QString& symbol)
+{
+    entries[symbol].lastViewed = QDateTime::currentDateTimeUtc();
+}
+
+void RefreshScheduler::setLastRefreshed(const QString& symbol, const QDateTime& when)
+{
+    entries[symbol].lastRefreshed = when.toUTC();
+}
+
+void RefreshScheduler::requestNow(const QString& symbol)
+{
+    Entry& entry = entries[symbol];
+    entry.forced = true;
+    entry.retryAfter = QDateTime();
+    tick();
+}
+
+void RefreshScheduler::refreshFinished(const QString& symbol, bool success)
+{
+    Entry& entry = entries[symbol];
+    entry.inFlight = false;
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    if (success)
+    {
+        entry.lastRefreshed = now;
+        entry.failures = 0;
+        entry.retryAfter = QDateTime();
+    }
+    else
+    {
+        ++entry.failures;
+        const int backoff = std::min(maximumBackoffSeconds, 60 << std::min(entry.failures - 1, 5));
+        entry.retryAfter = now.addSecs(backoff);
+    }
+}
+
+void RefreshScheduler::setRequestsPerMinute(int requestsPerMinute)
+{
+    this->requestsPerMinute = std::max(1, requestsPerMinute);
+}
+
+void RefreshScheduler::start(int tickMilliseconds)
+{
+    timer.start(tickMilliseconds);
+    tick();
+}
+
+void RefreshScheduler::stop()
+{
+    timer.stop();
+}
+
+bool RefreshScheduler::isMarketOpen(const QDateTime& when)
+{
+    const QDateTime local = when.toTimeZone(exchangeZone());
+    return isTradingDay(local.date()) && local.time() >= sessionOpen && local.time() < sessionClose;
+}
+
+QDateTime RefreshScheduler::lastSessionClose(const QDateTime& when)
+{
+    const QDateTime local = when.toTimeZone(exchangeZone());
+    QDate date = local.date();
+
+    for (int i = 0; i < 7; ++i, date = date.addDays(-1))
+    {
+        const QDateTime close(date, sessionClose, exchangeZone());
+        if (isTradingDay(date) && close <= when)
+            return close.toUTC();
+    }
+    return QDateTime();
+}
+
+bool RefreshScheduler::isDue(const Entry& entry, const QDateTime& now) const
+{
+    if (entry.inFlight || (entry.retryAfter.isValid() && now < entry.retryAfter))
+        return false;
+    if (entry.forced || !entry.lastRefreshed.isValid())
+        return true;
+
+    if (isMarketOpen(now))
+        return entry.lastRefreshed.secsTo(now) >= intradayInterval;
+
+    // Outside the session only the closing bar is new
+    const QDateTime published = lastSessionClose(now).addSecs(publishDelaySeconds);
+    return now >= published && entry.lastRefreshed < published;
+}
+
+bool RefreshScheduler::needsQuoteOnly(const Entry& entry, const QDateTime& now) const
+{
+    // During the session, once the previous close is cached, only today's bar changes
+    return quoteBatchSize > 1 && !entry.forced && isMarketOpen(now)
+        && entry.lastRefreshed >= lastSessionClose(now).addSecs(publishDelaySeconds);
+}
+
+bool RefreshScheduler::isHigherPriority(const QString& a, const QString& b) const
+{
+    const Entry& first = *entries.constFind(a);
+    const Entry& second = *entries.constFind(b);
+
+    if (first.forced != second.forced)
+        return first.forced;
+    if ((a == visibleSymbol) != (b == visibleSymbol))
+        return a == visibleSymbol;
+    if (first.lastViewed != second.lastViewed)
+        return first.lastViewed > second.lastViewed;   // invalid (never viewed) sorts last
+    return first.lastRefreshed < second.lastRefreshed;
+}
+
+void RefreshScheduler::tick()
+{
+    // Refill the token bucket; at most one minute's worth can accumulate
+    const double elapsedMinutes = bucketClock.restart() / 60000.0;
+    tokens = std::min<double>(requestsPerMinute, tokens + elapsedMinutes * requestsPerMinute);
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+
+    QStringList due;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+    {
+        if ((it.value().forced || symbols.contains(it.key())) && isDue(it.value(), now))
+            due << it.key();
+    }
+
+    std::sort(due.begin(), due.end(), [this](const QString& a, const QString& b) { return isHigherPriority(a, b); });
+
+    // A full refresh the bucket cannot afford yet does not hold up cheaper quotes behind it
+    for (const QString& symbol : due)
+    {
+        Entry& entry = entries[symbol];
+        const bool quoteOnly = needsQuoteOnly(entry, now);
+        const double cost = quoteOnly ? 1.0 / quoteBatchSize : 1.0;
+        if (tokens < cost)
+            continue;
+
+        tokens -= cost;
+        entry.inFlight = true;
+        entry.forced = false;
+        if (quoteOnly)
+            emit quoteRequested(symbol);
+        else
+            emit refreshRequested(symbol);
+    }
+}
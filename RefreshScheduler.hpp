@@ -0,0 +1,105 @@
+#ifndef REFRESHSCHEDULER_HPP
+#define REFRESHSCHEDULER_HPP
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+/**
+ * @brief Decides which watchlist symbol to refresh next.
+ *
+ * A symbol is due when it has never been fetched, when a trading session
+ * closed since its last refresh, or during market hours once the intraday
+ * interval has passed. Due symbols are ordered: explicit requests, the symbol
+ * on screen, recently viewed symbols, then the stalest. Requests are paced by
+ * a token bucket matching the API rate limit and failures back off
+ * exponentially. Exchange holidays are not modelled.
+ */
+class RefreshScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RefreshScheduler(QObject* parent = nullptr);
+
+    void setSymbols(const QStringList& symbols);
+
+    // The symbol currently on screen; refreshed before anything else that is due
+    void setVisible(const QString& symbol);
+
+    void markViewed(const QString& symbol);
+
+    // Seed the refresh time, e.g. from the modification time of the cached file
+    void setLastRefreshed(const QString& symbol, const QDateTime& when);
+
+    // Fetch this symbol as soon as the rate limit allows, due or not
+    void requestNow(const QString& symbol);
+
+    void refreshFinished(const QString& symbol, bool success);
+
+    void setRequestsPerMinute(int requestsPerMinute);
+
+    void setIntradayInterval(int seconds)
+    {
+        intradayInterval = seconds;
+    }
+
+    /**
+     * @brief Let intraday refreshes of symbols whose history is already
+     *        current go out as quotes, `symbolsPerRequest` of which share one
+     *        request and so one token. 0 or 1 disables quote refreshes.
+     */
+    void setQuoteBatchSize(int symbolsPerRequest)
+    {
+        quoteBatchSize = symbolsPerRequest;
+    }
+
+    void start(int tickMilliseconds = 1000);
+    void stop();
+
+    static bool isMarketOpen(const QDateTime& when);
+
+    // The most recent regular-session close at or before `when`
+    static QDateTime lastSessionClose(const QDateTime& when);
+
+signals:
+    void refreshRequested(const QString& symbol);
+
+    // Only the latest bar is needed; reported back through refreshFinished like a refresh
+    void quoteRequested(const QString& symbol);
+
+private slots:
+    void tick();
+
+private:
+    struct Entry
+    {
+        QDateTime lastRefreshed;
+        QDateTime lastViewed;
+        QDateTime retryAfter;
+        bool inFlight = false;
+        bool forced = false;
+        int failures = 0;
+    };
+
+    bool isDue(const Entry& entry, const QDateTime& now) const;
+    bool needsQuoteOnly(const Entry& entry, const QDateTime& now) const;
+    bool isHigherPriority(const QString& a, const QString& b) const;
+
+    QSet<QString> symbols;
+    QHash<QString, Entry> entries;
+    QString visibleSymbol;
+
+    QTimer timer;
+    QElapsedTimer bucketClock;
+    double tokens = 1;
+    int requestsPerMinute = 5;
+    int intradayInterval = 15 * 60;
+    int quoteBatchSize = 0;
+};
+
+#endif // REFRESHSCHEDULER_HPP
@@ -0,0 +1,121 @@
+#include <algorithm>
+
+#include <QMetaObject>
+#include <QThread>
+
+#include "RenderScheduler.hpp"
+
+RenderScheduler::RenderScheduler(QObject* parent)
+    : QObject(parent)
+{
+    // Leave a core for the GUI thread and the network
+    pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+
+    frameTimer.setSingleShot(true);
+    connect(&frameTimer, &QTimer::timeout, this, &RenderScheduler::renderFrame);
+    sinceLastFrame.start();
+}
+
+RenderScheduler::~RenderScheduler()
+{
+    // Pending jobs post back to this object, so none may outlive it
+    pool.clear();
+    pool.waitForDone();
+}
+
+void RenderScheduler::setMaxFramesPerSecond(int framesPerSecond)
+{
+    frameInterval = 1000 / std::clamp(framesPerSecond, 1, 240);
+}
+
+void RenderScheduler::reset(int tileCount)
+{
+    ++generation;
+    tiles = QVector<TileState>(std::max(0, tileCount));
+}
+
+void RenderScheduler::invalidate(int tile)
+{
+    if (tile < 0 || tile >= tiles.size())
+        return;
+
+    tiles[tile].dirty = true;
+    if (tiles[tile].visible)
+        scheduleFrame();
+}
+
+void RenderScheduler::invalidateAll()
+{
+    for (TileState& state : tiles)
+        state.dirty = true;
+    scheduleFrame();
+}
+
+void RenderScheduler::setVisible(int tile, bool visible)
+{
+    if (tile < 0 || tile >= tiles.size() || tiles[tile].visible == visible)
+        return;
+
+    tiles[tile].visible = visible;
+    if (visible && tiles[tile].dirty)
+        scheduleFrame();
+}
+
+void RenderScheduler::scheduleFrame()
+{
+    if (frameTimer.isActive())
+        return;
+
+    const qint64 wait = std::max<qint64>(0, frameInterval - sinceLastFrame.elapsed());
+    frameTimer.start(static_cast<int>(wait));
+}
+
+void RenderScheduler::renderFrame()
+{
+    if (!factory)
+        return;
+
+    bool started = false;
+    for (int tile = 0; tile < tiles.size(); ++tile)
+    {
+        TileState& state = tiles[tile];
+        if (!state.dirty || !state.visible || state.inFlight)
+            continue;
+
+        state.dirty = false;
+        state.inFlight = true;
+        started = true;
+        ++renderCount;
+
+        const RenderJob job = factory(tile);
+        const int frameGeneration = generation;
+        pool.start([this, job, frameGeneration, tile]()
+        {
+            const QImage image = job();
+            QMetaObject::invokeMethod(this, [this, frameGeneration, tile, image]()
+            {
+                finishTile(frameGeneration, tile, image);
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    if (started)
+    {
+        ++frameCount;
+        sinceLastFrame.restart();
+    }
+}
+
+void RenderScheduler::finishTile(int tileGeneration, int tile, const QImage& image)
+{
+    if (tileGeneration != generation)
+        return;
+
+    TileState& state = tiles[tile];
+    state.inFlight = false;
+    emit tileRendered(tile, image);
+
+    // Invalidated again while rendering
+    if (state.dirty && state.visible)
+        scheduleFrame();
+}
@@ -0,0 +1,87 @@
+#ifndef RENDERSCHEDULER_HPP
+#define RENDERSCHEDULER_HPP
+
+#include <functional>
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * @brief Renders many small views off the GUI thread at a bounded frame rate.
+ *
+ * Owners mark tiles dirty with invalidate(); invalidations are coalesced
+ * until the next frame, which starts at most maxFramesPerSecond times a
+ * second. A frame renders every dirty tile that is visible and not already
+ * being rendered, in parallel on a private thread pool, and hands the images
+ * back through tileRendered(). Tiles that are off screen stay dirty until
+ * they become visible again; a tile invalidated while its render is in flight
+ * is rendered once more in a later frame.
+ */
+class RenderScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Runs on a worker thread; it must only use what it captured
+    using RenderJob = std::function<QImage()>;
+
+    // Called on the GUI thread to snapshot whatever a tile needs for one render
+    using JobFactory = std::function<RenderJob(int tile)>;
+
+    explicit RenderScheduler(QObject* parent = nullptr);
+    ~RenderScheduler() override;
+
+    void setJobFactory(const JobFactory& factory)
+    {
+        this->factory = factory;
+    }
+
+    void setMaxFramesPerSecond(int framesPerSecond);
+
+    // Drop every tile and ignore results still in flight; new tiles start dirty and hidden
+    void reset(int tileCount);
+
+    void invalidate(int tile);
+    void invalidateAll();
+    void setVisible(int tile, bool visible);
+
+    int tileCount() const
+    {
+        return tiles.size();
+    }
+
+    // Frames that started at least one render, and tile renders in total
+    quint64 getFrameCount() const { return frameCount; }
+    quint64 getRenderCount() const { return renderCount; }
+
+signals:
+    void tileRendered(int tile, const QImage& image);
+
+private:
+    struct TileState
+    {
+        bool dirty = true;
+        bool visible = false;
+        bool inFlight = false;
+    };
+
+    void scheduleFrame();
+    void renderFrame();
+    void finishTile(int tileGeneration, int tile, const QImage& image);
+
+    JobFactory factory;
+    QVector<TileState> tiles;
+    QThreadPool pool;
+    QTimer frameTimer;
+    QElapsedTimer sinceLastFrame;
+    int frameInterval = 1000 / 30;   // milliseconds
+    int generation = 0;
+    quint64 frameCount = 0;
+    quint64 renderCount = 0;
+};
+
+#endif // RENDERSCHEDULER_HPP
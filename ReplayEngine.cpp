@@ -0,0 +1,131 @@
+#include <algorithm>
+
+#include "ReplayEngine.hpp"
+
+ReplayEngine::ReplayEngine(QObject* parent)
+    : QObject(parent)
+{
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, &QTimer::timeout, this, &ReplayEngine::tick);
+}
+
+void ReplayEngine::setSeries(const sv::SeriesPtr& history, int position)
+{
+    pause();
+    this->history = history;
+    statistics = ReplayStatistics();
+    seek(position);
+}
+
+void ReplayEngine::setSpeed(double speed)
+{
+    this->speed = std::max(0.0, speed);
+    pendingBars = 0;
+}
+
+void ReplayEngine::setTickInterval(int milliseconds)
+{
+    tickInterval = std::clamp(milliseconds, 1, 1000);
+    timer.setInterval(tickInterval);
+}
+
+void ReplayEngine::play()
+{
+    if (history.isNull() || position >= history->size())
+        return;
+
+    sinceTick.invalidate();
+    timer.start(tickInterval);
+}
+
+void ReplayEngine::pause()
+{
+    timer.stop();
+    sinceTick.invalidate();
+}
+
+void ReplayEngine::step()
+{
+    if (history.isNull() || isPlaying())
+        return;
+
+    deliver(1);
+    if (position >= history->size())
+        emit finished();
+}
+
+void ReplayEngine::seek(int position)
+{
+    if (history.isNull())
+        return;
+
+    this->position = std::clamp(position, 0, history->size());
+    pendingBars = 0;
+    emit rewound(history, this->position);
+}
+
+int ReplayEngine::positionFor(double time) const
+{
+    if (history.isNull())
+        return 0;
+
+    const double* times = history->column(sv::Series::Time);
+    return static_cast<int>(std::lower_bound(times, times + history->size(), time) - times);
+}
+
+void ReplayEngine::tick()
+{
+    if (sinceTick.isValid())
+    {
+        const qint64 elapsed = sinceTick.restart();
+        statistics.wallSeconds += elapsed / 1000.0;
+        if (elapsed > 2 * tickInterval)
+            ++statistics.lateTicks;
+    }
+    else
+    {
+        sinceTick.start();
+    }
+    ++statistics.ticks;
+
+    if (speed > 0)
+    {
+        pendingBars += speed * tickInterval / 1000.0;
+        const int count = static_cast<int>(pendingBars);
+        pendingBars -= count;
+        deliver(count);
+    }
+    else
+    {
+        // Unthrottled: keep delivering until this tick's time is used up
+        QElapsedTimer budget;
+        budget.start();
+        while (position < history->size() && budget.elapsed() < tickInterval)
+            deliver(64);
+    }
+
+    if (position >= history->size())
+    {
+        pause();
+        emit finished();
+    }
+}
+
+void ReplayEngine::deliver(int count)
+{
+    count = std::min(count, history->size() - position);
+    if (count <= 0)
+        return;
+
+    QVector<sv::Bar> bars;
+    bars.reserve(count);
+    for (int i = 0; i < count; ++i)
+        bars.append(history->bar(position + i));
+    position += count;
+
+    QElapsedTimer delivery;
+    delivery.start();
+    emit barsReplayed(history->getSymbol(), bars);
+    statistics.deliverySeconds += delivery.nsecsElapsed() / 1e9;
+    statistics.bars += count;
+}
@@ -0,0 +1,114 @@
+#ifndef REPLAYENGINE_HPP
+#define REPLAYENGINE_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include "Series.hpp"
+
+struct ReplayStatistics
+{
+    quint64 bars = 0;
+    quint64 ticks = 0;
+    quint64 lateTicks = 0;           // ticks that fired more than one interval late
+    double wallSeconds = 0;          // time spent playing
+    double deliverySeconds = 0;      // time spent in barsReplayed receivers
+
+    double barsPerSecond() const
+    {
+        return wallSeconds > 0 ? bars / wallSeconds : 0;
+    }
+};
+
+/**
+ * @brief Plays a stored series back bar by bar as if it were arriving live.
+ *
+ * Replay time is counted in bars rather than in the series' own timestamps,
+ * since cached histories are daily: at 1x one bar is delivered per second,
+ * at 10000x ten thousand. The replay clock advances by a fixed step per timer
+ * tick, so the bars delivered on each tick depend only on the speed and the
+ * tick count; when receivers cannot keep up the replay slows down instead of
+ * skipping. A speed of 0 delivers as many bars per tick as fit in one tick
+ * interval.
+ */
+class ReplayEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReplayEngine(QObject* parent = nullptr);
+
+    // Pauses and rewinds to `position` bars of history already delivered
+    void setSeries(const sv::SeriesPtr& history, int position = 0);
+
+    sv::SeriesPtr getSeries() const
+    {
+        return history;
+    }
+
+    void setSpeed(double speed);
+
+    double getSpeed() const
+    {
+        return speed;
+    }
+
+    void setTickInterval(int milliseconds);
+
+    void play();
+    void pause();
+    void step();
+
+    // Bars [0, position) count as delivered; receivers are told to rebuild from them
+    void seek(int position);
+
+    // Position of the first bar at or after `time`
+    int positionFor(double time) const;
+
+    bool isPlaying() const
+    {
+        return timer.isActive();
+    }
+
+    bool isActive() const
+    {
+        return !history.isNull();
+    }
+
+    int getPosition() const
+    {
+        return position;
+    }
+
+    const ReplayStatistics& getStatistics() const
+    {
+        return statistics;
+    }
+
+signals:
+    // The replay jumped; everything delivered so far is history->mid(0, position)
+    void rewound(const sv::SeriesPtr& history, int position);
+
+    void barsReplayed(const QString& symbol, const QVector<sv::Bar>& bars);
+
+    void finished();
+
+private slots:
+    void tick();
+
+private:
+    void deliver(int count);
+
+    sv::SeriesPtr history;
+    int position = 0;
+    double speed = 100;
+    double pendingBars = 0;          // fractional bars carried to the next tick
+    int tickInterval = 16;
+    QTimer timer;
+    QElapsedTimer sinceTick;
+    ReplayStatistics statistics;
+};
+
+#endif // REPLAYENGINE_HPP
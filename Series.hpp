@@ -0,0 +1,199 @@
+#ifndef SERIES_HPP
+#define SERIES_HPP
+
+#include <algorithm>
+#include <numeric>
+
+#include <QPointF>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+namespace sv
+{
+
+// One OHLCV bar; time is a UNIX timestamp in seconds
+struct Bar
+{
+    double time = 0;
+    double open = 0;
+    double high = 0;
+    double low = 0;
+    double close = 0;
+    double volume = 0;
+};
+
+// Columnar price history for a single symbol. Each column is a contiguous
+// array of doubles so it can be handed to plugins and numeric kernels as-is.
+class Series
+{
+public:
+    enum Column { Time, Open, High, Low, Close, Volume, ColumnCount };
+
+    Series() = default;
+
+    explicit Series(const QString& symbol)
+        : symbol{symbol}
+    {
+    }
+
+    QString getSymbol() const
+    {
+        return symbol;
+    }
+
+    void setSymbol(const QString& symbol)
+    {
+        this->symbol = symbol;
+    }
+
+    int size() const
+    {
+        return columns[Time].size();
+    }
+
+    bool isEmpty() const
+    {
+        return columns[Time].isEmpty();
+    }
+
+    const double* column(Column column) const
+    {
+        return columns[column].constData();
+    }
+
+    double at(Column column, int index) const
+    {
+        return columns[column].at(index);
+    }
+
+    Bar bar(int index) const
+    {
+        return Bar{ columns[Time].at(index), columns[Open].at(index), columns[High].at(index),
+                    columns[Low].at(index), columns[Close].at(index), columns[Volume].at(index) };
+    }
+
+    double firstTime() const
+    {
+        return columns[Time].first();
+    }
+
+    double lastTime() const
+    {
+        return columns[Time].last();
+    }
+
+    void reserve(int rows)
+    {
+        for (QVector<double>& values : columns)
+            values.reserve(rows);
+    }
+
+    void append(const Bar& bar)
+    {
+        columns[Time].append(bar.time);
+        columns[Open].append(bar.open);
+        columns[High].append(bar.high);
+        columns[Low].append(bar.low);
+        columns[Close].append(bar.close);
+        columns[Volume].append(bar.volume);
+    }
+
+    // Overwrite the latest bar; the series must not be empty
+    void replaceLast(const Bar& bar)
+    {
+        const int last = size() - 1;
+        columns[Time][last] = bar.time;
+        columns[Open][last] = bar.open;
+        columns[High][last] = bar.high;
+        columns[Low][last] = bar.low;
+        columns[Close][last] = bar.close;
+        columns[Volume][last] = bar.volume;
+    }
+
+    bool isSorted() const
+    {
+        return std::is_sorted(columns[Time].cbegin(), columns[Time].cend());
+    }
+
+    // Reorder every column by ascending timestamp
+    void sortByTime()
+    {
+        if (isSorted())
+            return;
+
+        QVector<int> order(size());
+        std::iota(order.begin(), order.end(), 0);
+        const QVector<double>& time = columns[Time];
+        std::stable_sort(order.begin(), order.end(),
+                         [&time](int a, int b) { return time[a] < time[b]; });
+
+        for (QVector<double>& values : columns)
+        {
+            QVector<double> sorted;
+            sorted.reserve(values.size());
+            for (int index : order)
+                sorted.append(values[index]);
+            values = std::move(sorted);
+        }
+    }
+
+    // History from `older` up to where `newer` starts, followed by all of `newer`.
+    // Used to splice a freshly downloaded tail onto a cached series.
+    static Series merge(const Series& older, const Series& newer)
+    {
+        if (newer.isEmpty())
+            return older;
+
+        Series result{newer.symbol.isEmpty() ? older.symbol : newer.symbol};
+        const double start = newer.firstTime();
+        const int keep = static_cast<int>(std::lower_bound(older.columns[Time].cbegin(), older.columns[Time].cend(), start)
+                                          - older.columns[Time].cbegin());
+
+        result.reserve(keep + newer.size());
+        for (int i = 0; i < keep; ++i)
+            result.append(older.bar(i));
+        for (int i = 0; i < newer.size(); ++i)
+            result.append(newer.bar(i));
+        return result;
+    }
+
+    // Rows [position, position + length); a negative length means through the end
+    Series mid(int position, int length = -1) const
+    {
+        Series result{symbol};
+        for (int column = 0; column < ColumnCount; ++column)
+            result.columns[column] = columns[column].mid(position, length);
+        return result;
+    }
+
+    QVector<QPointF> toPoints(Column column = Close) const
+    {
+        QVector<QPointF> points;
+        points.reserve(size());
+        for (int i = 0; i < size(); ++i)
+            points.append(QPointF(columns[Time][i], columns[column][i]));
+        return points;
+    }
+
+    // Build a close-only series, e.g. from a two-column timestamp,price file
+    static Series fromPoints(const QString& symbol, const QVector<QPointF>& points)
+    {
+        Series series{symbol};
+        series.reserve(points.size());
+        for (const QPointF& point : points)
+            series.append(Bar{ point.x(), point.y(), point.y(), point.y(), point.y(), 0 });
+        return series;
+    }
+
+private:
+    QString symbol;
+    QVector<double> columns[ColumnCount];
+};
+
+// Series are immutable once published; share them instead of copying
+using SeriesPtr = QSharedPointer<const Series>;
+
+}
+
+#endif // SERIES_HPP
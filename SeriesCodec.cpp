@@ -0,0 +1,608 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "SeriesCodec.hpp"
+
+namespace sv
+{
+
+namespace
+{
+
+const char archiveMagic[4] = { 'S', 'V', 'A', '1' };
+
+struct ArchiveHeader
+{
+    char magic[4];
+    quint32 blockCount;
+    qint64 rowCount;
+};
+
+enum Encoding : quint64 { Integer = 0, Decimal = 0, Xor = 1 };
+
+const int maxDecimals = 6;
+const double maxExact = 4503599627370496.0;   // 2^52: beyond this doubles are not all integers
+
+quint64 toBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(quint64 bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+quint64 zigzag(qint64 value)
+{
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+qint64 unzigzag(quint64 value)
+{
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+// Scaled-integer encodings would turn -0.0 into 0.0
+bool isNegativeZero(double value)
+{
+    return value == 0 && std::signbit(value);
+}
+
+int leadingZeros(quint64 value)
+{
+    int count = 0;
+    for (quint64 mask = quint64(1) << 63; mask != 0 && (value & mask) == 0; mask >>= 1)
+        ++count;
+    return count;
+}
+
+int trailingZeros(quint64 value)
+{
+    int count = 0;
+    for (; count < 64 && (value & 1) == 0; value >>= 1)
+        ++count;
+    return count;
+}
+
+// MSB-first bit stream over a byte array
+class BitWriter
+{
+public:
+    void write(quint64 value, int bits)
+    {
+        while (bits > 0)
+        {
+            const int space = 8 - used;
+            const int count = std::min(space, bits);
+            const quint64 chunk = (value >> (bits - count)) & ((1u << count) - 1);
+            current |= static_cast<quint8>(chunk << (space - count));
+            used += count;
+            bits -= count;
+            if (used == 8)
+                flushByte();
+        }
+    }
+
+    void writeVarint(quint64 value)
+    {
+        while (value >= 0x80)
+        {
+            write((value & 0x7f) | 0x80, 8);
+            value >>= 7;
+        }
+        write(value, 8);
+    }
+
+    QByteArray finish()
+    {
+        if (used > 0)
+            flushByte();
+        return bytes;
+    }
+
+private:
+    void flushByte()
+    {
+        bytes.append(static_cast<char>(current));
+        current = 0;
+        used = 0;
+    }
+
+    QByteArray bytes;
+    quint8 current = 0;
+    int used = 0;
+};
+
+class BitReader
+{
+public:
+    BitReader(const uchar* data, qint64 size)
+        : data(data), size(size)
+    {
+    }
+
+    quint64 read(int bits)
+    {
+        quint64 value = 0;
+        while (bits > 0)
+        {
+            if (byte >= size)
+            {
+                overrun = true;
+                return 0;
+            }
+            const int available = 8 - used;
+            const int count = std::min(available, bits);
+            const quint64 chunk = (data[byte] >> (available - count)) & ((1u << count) - 1);
+            value = (value << count) | chunk;
+            used += count;
+            bits -= count;
+            if (used == 8)
+            {
+                ++byte;
+                used = 0;
+            }
+        }
+        return value;
+    }
+
+    quint64 readVarint()
+    {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            const quint64 group = read(8);
+            value |= (group & 0x7f) << shift;
+            if ((group & 0x80) == 0)
+                break;
+        }
+        return value;
+    }
+
+    bool failed() const
+    {
+        return overrun;
+    }
+
+private:
+    const uchar* data;
+    qint64 size;
+    qint64 byte = 0;
+    int used = 0;
+    bool overrun = false;
+};
+
+// Gorilla XOR encoding: identical values cost one bit, and a changed value only
+// stores the bits between the leading and trailing zeros of the XOR
+class XorEncoder
+{
+public:
+    void encode(BitWriter& out, const double* values, int count)
+    {
+        if (count == 0)
+            return;
+
+        quint64 previous = toBits(values[0]);
+        out.write(previous, 64);
+
+        int windowLeading = -1;
+        int windowTrailing = 0;
+        for (int i = 1; i < count; ++i)
+        {
+            const quint64 bits = toBits(values[i]);
+            const quint64 delta = bits ^ previous;
+            previous = bits;
+
+            if (delta == 0)
+            {
+                out.write(0, 1);
+                continue;
+            }
+
+            const int leading = std::min(leadingZeros(delta), 31);
+            const int trailing = trailingZeros(delta);
+            if (windowLeading >= 0 && leading >= windowLeading && trailing >= windowTrailing)
+            {
+                out.write(0b10, 2);
+                out.write(delta >> windowTrailing, 64 - windowLeading - windowTrailing);
+            }
+            else
+            {
+                const int meaningful = 64 - leading - trailing;
+                out.write(0b11, 2);
+                out.write(leading, 5);
+                out.write(meaningful - 1, 6);
+                out.write(delta >> trailing, meaningful);
+                windowLeading = leading;
+                windowTrailing = trailing;
+            }
+        }
+    }
+
+    static void decode(BitReader& in, double* values, int count)
+    {
+        if (count == 0)
+            return;
+
+        quint64 previous = in.read(64);
+        values[0] = fromBits(previous);
+
+        int windowLeading = 0;
+        int windowTrailing = 0;
+        for (int i = 1; i < count; ++i)
+        {
+            if (in.read(1) != 0)
+            {
+                if (in.read(1) != 0)
+                {
+                    windowLeading = static_cast<int>(in.read(5));
+                    windowTrailing = 64 - windowLeading - (static_cast<int>(in.read(6)) + 1);
+                }
+                previous ^= in.read(64 - windowLeading - windowTrailing) << windowTrailing;
+            }
+            values[i] = fromBits(previous);
+        }
+    }
+};
+
+// Delta-of-delta buckets: a control prefix followed by a signed value of the given width
+struct Bucket
+{
+    quint64 prefix;
+    int prefixBits;
+    int valueBits;
+};
+
+const Bucket timeBuckets[] = {
+    { 0b10, 2, 7 },
+    { 0b110, 3, 12 },
+    { 0b1110, 4, 20 },                 // weekend gaps of daily bars fit here
+    { 0b1111, 4, 64 },
+};
+
+void encodeTimes(BitWriter& out, const double* times, int count)
+{
+    const bool integral = std::all_of(times, times + count,
+                                      [](double t) { return std::floor(t) == t && std::abs(t) < maxExact && !isNegativeZero(t); });
+    out.write(integral ? Integer : Xor, 1);
+    if (!integral)
+    {
+        XorEncoder().encode(out, times, count);
+        return;
+    }
+
+    qint64 previous = static_cast<qint64>(times[0]);
+    out.writeVarint(zigzag(previous));
+    qint64 previousDelta = 0;
+
+    for (int i = 1; i < count; ++i)
+    {
+        const qint64 time = static_cast<qint64>(times[i]);
+        const qint64 delta = time - previous;
+        const qint64 deltaOfDelta = delta - previousDelta;
+        previous = time;
+        previousDelta = delta;
+
+        if (deltaOfDelta == 0)
+        {
+            out.write(0, 1);
+            continue;
+        }
+
+        for (const Bucket& bucket : timeBuckets)
+        {
+            const qint64 limit = bucket.valueBits == 64 ? 0 : qint64(1) << (bucket.valueBits - 1);
+            if (bucket.valueBits == 64 || (deltaOfDelta >= -limit && deltaOfDelta < limit))
+            {
+                out.write(bucket.prefix, bucket.prefixBits);
+                out.write(static_cast<quint64>(deltaOfDelta), bucket.valueBits);
+                break;
+            }
+        }
+    }
+}
+
+void decodeTimes(BitReader& in, double* times, int count)
+{
+    if (in.read(1) == Xor)
+    {
+        XorEncoder::decode(in, times, count);
+        return;
+    }
+
+    qint64 previous = unzigzag(in.readVarint());
+    times[0] = static_cast<double>(previous);
+    qint64 previousDelta = 0;
+
+    for (int i = 1; i < count; ++i)
+    {
+        qint64 deltaOfDelta = 0;
+        if (in.read(1) != 0)
+        {
+            int valueBits = 64;
+            if (in.read(1) == 0)
+                valueBits = 7;
+            else if (in.read(1) == 0)
+                valueBits = 12;
+            else if (in.read(1) == 0)
+                valueBits = 20;
+
+            const quint64 raw = in.read(valueBits);
+            deltaOfDelta = valueBits == 64 ? static_cast<qint64>(raw)
+                                           : static_cast<qint64>(raw << (64 - valueBits)) >> (64 - valueBits);
+        }
+
+        previousDelta += deltaOfDelta;
+        previous += previousDelta;
+        times[i] = static_cast<double>(previous);
+    }
+}
+
+// Smallest number of decimals at which every value is an exact scaled integer, or -1
+int decimalScale(const double* const* columns, int columnCount, int count)
+{
+    for (int decimals = 0; decimals <= maxDecimals; ++decimals)
+    {
+        const double scale = std::pow(10.0, decimals);
+        bool exact = true;
+        for (int c = 0; c < columnCount && exact; ++c)
+        {
+            for (int i = 0; i < count && exact; ++i)
+            {
+                const double scaled = columns[c][i] * scale;
+                exact = std::abs(scaled) < maxExact && !isNegativeZero(columns[c][i])
+                        && static_cast<double>(std::llround(scaled)) / scale == columns[c][i];
+            }
+        }
+        if (exact)
+            return decimals;
+    }
+    return -1;
+}
+
+int bitWidth(quint64 value)
+{
+    return 64 - leadingZeros(value);
+}
+
+// Close as deltas from the previous close; open, high and low as offsets from
+// the close. Each of the four streams is bit-packed at the width of its largest value.
+void encodePrices(BitWriter& out, const double* open, const double* high, const double* low,
+                  const double* close, int count)
+{
+    const double* columns[] = { close, open, high, low };
+    const int decimals = decimalScale(columns, 4, count);
+    out.write(decimals < 0 ? Xor : Decimal, 1);
+
+    if (decimals < 0)
+    {
+        for (const double* column : columns)
+            XorEncoder().encode(out, column, count);
+        return;
+    }
+
+    const double scale = std::pow(10.0, decimals);
+    std::vector<quint64> streams[4];
+    int widths[4] = { 0, 0, 0, 0 };
+    qint64 previousClose = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const qint64 scaledClose = std::llround(close[i] * scale);
+        const quint64 values[4] = {
+            zigzag(scaledClose - previousClose),
+            zigzag(std::llround(open[i] * scale) - scaledClose),
+            zigzag(std::llround(high[i] * scale) - scaledClose),
+            zigzag(std::llround(low[i] * scale) - scaledClose)
+        };
+        for (int s = 0; s < 4; ++s)
+        {
+            streams[s].push_back(values[s]);
+            widths[s] = std::max(widths[s], bitWidth(values[s]));
+        }
+        previousClose = scaledClose;
+    }
+
+    out.write(decimals, 3);
+    for (int s = 0; s < 4; ++s)
+    {
+        out.write(widths[s], 7);
+        for (quint64 value : streams[s])
+            out.write(value, widths[s]);
+    }
+}
+
+void decodePrices(BitReader& in, double* open, double* high, double* low, double* close, int count)
+{
+    if (in.read(1) == Xor)
+    {
+        for (double* column : { close, open, high, low })
+            XorEncoder::decode(in, column, count);
+        return;
+    }
+
+    const double scale = std::pow(10.0, static_cast<int>(in.read(3)));
+
+    int width = static_cast<int>(in.read(7));
+    qint64 scaledClose = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        scaledClose += unzigzag(in.read(width));
+        close[i] = static_cast<double>(scaledClose) / scale;
+    }
+
+    for (double* column : { open, high, low })
+    {
+        width = static_cast<int>(in.read(7));
+        for (int i = 0; i < count; ++i)
+            column[i] = static_cast<double>(std::llround(close[i] * scale) + unzigzag(in.read(width))) / scale;
+    }
+}
+
+void encodeVolumes(BitWriter& out, const double* volumes, int count)
+{
+    const bool integral = std::all_of(volumes, volumes + count, [](double v)
+    {
+        return v >= 0 && v < maxExact && std::floor(v) == v && !isNegativeZero(v);
+    });
+    out.write(integral ? Integer : Xor, 1);
+
+    if (!integral)
+    {
+        XorEncoder().encode(out, volumes, count);
+        return;
+    }
+
+    for (int i = 0; i < count; ++i)
+        out.writeVarint(static_cast<quint64>(volumes[i]));
+}
+
+void decodeVolumes(BitReader& in, double* volumes, int count)
+{
+    if (in.read(1) == Xor)
+    {
+        XorEncoder::decode(in, volumes, count);
+        return;
+    }
+
+    for (int i = 0; i < count; ++i)
+        volumes[i] = static_cast<double>(in.readVarint());
+}
+
+bool readHeader(const char* data, qint64 size, ArchiveHeader& header)
+{
+    if (data == nullptr || size < static_cast<qint64>(sizeof(ArchiveHeader)))
+        return false;
+
+    std::memcpy(&header, data, sizeof(header));
+    const qint64 indexEnd = static_cast<qint64>(sizeof(ArchiveHeader))
+        + static_cast<qint64>(header.blockCount) * static_cast<qint64>(sizeof(ArchiveBlock));
+    return std::memcmp(header.magic, archiveMagic, sizeof(archiveMagic)) == 0
+        && header.rowCount >= 0 && indexEnd <= size;
+}
+
+}
+
+bool SeriesCodec::isArchive(const char* data, qint64 size)
+{
+    ArchiveHeader header;
+    return readHeader(data, size, header);
+}
+
+QByteArray SeriesCodec::encode(const Series& series, int blockRows)
+{
+    blockRows = std::max(blockRows, 1);
+    const int rows = series.size();
+    const int blockCount = (rows + blockRows - 1) / blockRows;
+
+    const double* time = series.column(Series::Time);
+    const double* open = series.column(Series::Open);
+    const double* high = series.column(Series::High);
+    const double* low = series.column(Series::Low);
+    const double* close = series.column(Series::Close);
+    const double* volume = series.column(Series::Volume);
+
+    QVector<ArchiveBlock> index;
+    QVector<QByteArray> payloads;
+    qint64 offset = static_cast<qint64>(sizeof(ArchiveHeader)) + blockCount * static_cast<qint64>(sizeof(ArchiveBlock));
+
+    for (int first = 0; first < rows; first += blockRows)
+    {
+        const int count = std::min(blockRows, rows - first);
+
+        BitWriter out;
+        encodeTimes(out, time + first, count);
+        encodePrices(out, open + first, high + first, low + first, close + first, count);
+        encodeVolumes(out, volume + first, count);
+        const QByteArray payload = out.finish();
+
+        ArchiveBlock block;
+        block.offset = offset;
+        block.size = payload.size();
+        block.rows = count;
+        block.firstTime = time[first];
+        block.lastTime = time[first + count - 1];
+        block.low = *std::min_element(low + first, low + first + count);
+        block.high = *std::max_element(high + first, high + first + count);
+
+        index.append(block);
+        payloads.append(payload);
+        offset += payload.size();
+    }
+
+    ArchiveHeader header;
+    std::memcpy(header.magic, archiveMagic, sizeof(archiveMagic));
+    header.blockCount = static_cast<quint32>(blockCount);
+    header.rowCount = rows;
+
+    QByteArray archive;
+    archive.reserve(static_cast<int>(offset));
+    archive.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const ArchiveBlock& block : index)
+        archive.append(reinterpret_cast<const char*>(&block), sizeof(block));
+    for (const QByteArray& payload : payloads)
+        archive.append(payload);
+    return archive;
+}
+
+QVector<ArchiveBlock> SeriesCodec::blocks(const char* data, qint64 size)
+{
+    QVector<ArchiveBlock> index;
+    ArchiveHeader header;
+    if (!readHeader(data, size, header))
+        return index;
+
+    index.resize(static_cast<int>(header.blockCount));
+    if (!index.isEmpty())
+        std::memcpy(index.data(), data + sizeof(ArchiveHeader), index.size() * sizeof(ArchiveBlock));
+    return index;
+}
+
+bool SeriesCodec::decode(const char* data, qint64 size, Series& series, double from, double to)
+{
+    const QVector<ArchiveBlock> index = blocks(data, size);
+    if (index.isEmpty() && !isArchive(data, size))
+        return false;
+
+    // Blocks are in time order, so the overlapping ones are a contiguous run
+    auto first = std::lower_bound(index.cbegin(), index.cend(), from,
+                                  [](const ArchiveBlock& block, double time) { return block.lastTime < time; });
+
+    std::vector<double> columns[Series::ColumnCount];
+    for (auto it = first; it != index.cend() && it->firstTime <= to; ++it)
+    {
+        const ArchiveBlock& block = *it;
+        if (block.offset < 0 || block.rows < 0 || block.size < 0 || block.offset + block.size > size)
+            return false;
+
+        for (std::vector<double>& column : columns)
+            column.resize(block.rows);
+
+        BitReader in(reinterpret_cast<const uchar*>(data + block.offset), block.size);
+        decodeTimes(in, columns[Series::Time].data(), block.rows);
+        decodePrices(in, columns[Series::Open].data(), columns[Series::High].data(), columns[Series::Low].data(),
+                     columns[Series::Close].data(), block.rows);
+        decodeVolumes(in, columns[Series::Volume].data(), block.rows);
+        if (in.failed())
+            return false;
+
+        for (int i = 0; i < block.rows; ++i)
+        {
+            const double time = columns[Series::Time][i];
+            if (time >= from && time <= to)
+            {
+                series.append(Bar{ time, columns[Series::Open][i], columns[Series::High][i], columns[Series::Low][i],
+                                   columns[Series::Close][i], columns[Series::Volume][i] });
+            }
+        }
+    }
+    return true;
+}
+
+}
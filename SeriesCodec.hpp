@@ -0,0 +1,67 @@
+#ifndef SERIESCODEC_HPP
+#define SERIESCODEC_HPP
+
+#include <limits>
+
+#include <QByteArray>
+#include <QVector>
+
+#include "Series.hpp"
+
+namespace sv
+{
+
+// Location and bounds of one block of a compressed series
+struct ArchiveBlock
+{
+    qint64 offset;                   // from the start of the archive
+    qint32 size;                     // encoded bytes
+    qint32 rows;
+    double firstTime;
+    double lastTime;
+    double low;                      // lowest low in the block
+    double high;                     // highest high in the block
+};
+
+/**
+ * @brief Compressed archive format for series.
+ *
+ * Rows are split into fixed-size blocks, each encoded on its own behind an
+ * index of ArchiveBlock headers, so a time-range query decodes only the blocks
+ * it overlaps. Within a block:
+ *
+ *  - timestamps are delta-of-delta encoded with variable-width buckets; a run
+ *    of evenly spaced bars costs one bit per bar,
+ *  - prices that are exact decimals (as the API delivers them) are stored as
+ *    scaled integers: the close as a delta from the previous close and
+ *    open/high/low as offsets from the close, bit-packed at the block's widest
+ *    value; other prices fall back to Gorilla-style XOR encoding against the
+ *    previous value in the column,
+ *  - integral volumes are varints, anything else is XOR encoded.
+ *
+ * Decoding is lossless: every double round-trips bit for bit.
+ */
+class SeriesCodec
+{
+public:
+    static constexpr int defaultBlockRows = 512;
+
+    static bool isArchive(const char* data, qint64 size);
+
+    static QByteArray encode(const Series& series, int blockRows = defaultBlockRows);
+
+    /**
+     * @brief Decode the rows with from <= time <= to, appending them to `series`.
+     * @return False if the data is not a valid archive.
+     */
+    static bool decode(const char* data, qint64 size, Series& series,
+                       double from = -std::numeric_limits<double>::infinity(),
+                       double to = std::numeric_limits<double>::infinity());
+
+    // The block index, or an empty vector if the data is not a valid archive
+    static QVector<ArchiveBlock> blocks(const char* data, qint64 size);
+};
+
+}
+
+#endif // SERIESCODEC_HPP
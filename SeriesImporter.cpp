@@ -0,0 +1,463 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+
+#include "SeriesImporter.hpp"
+
+namespace sv
+{
+
+namespace
+{
+
+enum Field { TimeField, OpenField, HighField, LowField, CloseField, VolumeField, FieldCount };
+
+const double powersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+struct Token
+{
+    const char* begin;
+    const char* end;
+};
+
+Token trimmed(const char* begin, const char* end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '"' || *begin == '\t'))
+        ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '"' || end[-1] == '\t' || end[-1] == '\r'))
+        --end;
+    return { begin, end };
+}
+
+// Plain decimal with optional sign, fraction and exponent; the whole token must be used
+bool parseNumber(Token token, double& value)
+{
+    const char* p = token.begin;
+    const char* end = token.end;
+    if (p == end)
+        return false;
+
+    const bool negative = *p == '-';
+    if (*p == '-' || *p == '+')
+        ++p;
+
+    quint64 mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+    {
+        if (mantissa < 1000000000000000000ull)
+            mantissa = mantissa * 10 + (*p - '0');
+        else
+            ++exponent;
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+        {
+            if (mantissa < 1000000000000000000ull)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                --exponent;
+            }
+        }
+    }
+    if (digits == 0)
+        return false;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        const bool negativeExponent = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+'))
+            ++p;
+        int e = 0;
+        if (p == end || *p < '0' || *p > '9')
+            return false;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p)
+            e = std::min(e * 10 + (*p - '0'), 10000);
+        exponent += negativeExponent ? -e : e;
+    }
+    if (p != end)
+        return false;
+
+    // Exact operands, so one correctly rounded operation for typical prices
+    value = static_cast<double>(mantissa);
+    if (exponent < 0)
+        value = -exponent <= 22 ? value / powersOfTen[-exponent] : value * std::pow(10.0, exponent);
+    else if (exponent > 0)
+        value = exponent <= 22 ? value * powersOfTen[exponent] : value * std::pow(10.0, exponent);
+    if (negative)
+        value = -value;
+    return std::isfinite(value);
+}
+
+int parseDigits(const char* p, int count)
+{
+    int value = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (p[i] < '0' || p[i] > '9')
+            return -1;
+        value = value * 10 + (p[i] - '0');
+    }
+    return value;
+}
+
+// yyyy-MM-dd[( |T)HH:mm[:ss]] to the local-midnight based timestamp the API
+// series use, or Unix seconds (milliseconds if implausibly large)
+bool parseTime(Token token, double& time)
+{
+    const char* p = token.begin;
+    const qint64 length = token.end - token.begin;
+    if (length < 10 || p[4] != '-' || p[7] != '-')
+    {
+        if (!parseNumber(token, time))
+            return false;
+        if (time > 1e11)
+            time /= 1000;
+        return true;
+    }
+
+    const int year = parseDigits(p, 4);
+    const int month = parseDigits(p + 5, 2);
+    const int day = parseDigits(p + 8, 2);
+    if (year < 0 || month < 0 || day < 0)
+        return false;
+
+    // Every symbol shares the same trading days, so each thread converts each date once
+    thread_local QHash<int, double> midnights;
+    const int key = year * 10000 + month * 100 + day;
+    auto it = midnights.constFind(key);
+    if (it == midnights.constEnd())
+    {
+        const QDate date(year, month, day);
+        if (!date.isValid())
+            return false;
+        it = midnights.insert(key, static_cast<double>(date.startOfDay().toSecsSinceEpoch()));
+    }
+    time = it.value();
+
+    if (length >= 16 && (p[10] == ' ' || p[10] == 'T') && p[13] == ':')
+    {
+        const int hours = parseDigits(p + 11, 2);
+        const int minutes = parseDigits(p + 14, 2);
+        const int seconds = length >= 19 && p[16] == ':' ? parseDigits(p + 17, 2) : 0;
+        if (hours < 0 || minutes < 0 || seconds < 0)
+            return false;
+        time += hours * 3600 + minutes * 60 + seconds;
+    }
+    return true;
+}
+
+int fieldFor(QByteArray name)
+{
+    name = name.trimmed().toLower();
+    name.replace('"', "");
+    name.replace('_', ' ');
+    if (name.startsWith("\xEF\xBB\xBF"))
+        name.remove(0, 3);
+
+    if (name == "date" || name == "timestamp" || name == "time" || name == "datetime" || name == "day")
+        return TimeField;
+    if (name == "open")
+        return OpenField;
+    if (name == "high")
+        return HighField;
+    if (name == "low")
+        return LowField;
+    if (name == "close" || name == "price" || name == "last")
+        return CloseField;
+    if (name == "volume" || name == "vol")
+        return VolumeField;
+    return -1;
+}
+
+QFileInfoList importFiles(const QString& directory)
+{
+    return QDir(directory).entryInfoList({ "*.csv", "*.parquet" }, QDir::Files, QDir::Name);
+}
+
+}
+
+SeriesImporter::SeriesImporter(const SeriesStore* store)
+    : store(store)
+{
+}
+
+bool SeriesImporter::parseCsv(const char* data, qint64 size, Series& series, qint64* rejectedRows, QString* error)
+{
+    const char* const end = data + size;
+    const char* lineEnd = static_cast<const char*>(std::memchr(data, '\n', size));
+    if (lineEnd == nullptr)
+        lineEnd = end;
+
+    // Column index of each field, -1 if absent
+    QVector<int> columnField;
+    int fieldColumns[FieldCount];
+    std::fill(fieldColumns, fieldColumns + FieldCount, -1);
+    for (const QByteArray& name : QByteArray(data, static_cast<int>(lineEnd - data)).split(','))
+    {
+        const int field = fieldFor(name);
+        if (field >= 0 && fieldColumns[field] < 0)
+            fieldColumns[field] = columnField.size();
+        columnField.append(field >= 0 && fieldColumns[field] == columnField.size() ? field : -1);
+    }
+
+    if (fieldColumns[TimeField] < 0 || fieldColumns[CloseField] < 0)
+    {
+        if (error != nullptr)
+            *error = fieldColumns[TimeField] < 0 ? "no date column in header" : "no close column in header";
+        return false;
+    }
+
+    // Daily files run about 50 bytes a row
+    series.reserve(static_cast<int>(std::min<qint64>(size / 40 + 1, 1 << 24)));
+
+    qint64 rejected = 0;
+    for (const char* line = lineEnd; line < end; line = lineEnd)
+    {
+        ++line;
+        lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (lineEnd == nullptr)
+            lineEnd = end;
+        const Token whole = trimmed(line, lineEnd);
+        if (whole.begin == whole.end)
+            continue;
+
+        double values[FieldCount] = { 0, 0, 0, 0, 0, 0 };
+        bool present[FieldCount] = { false, false, false, false, false, false };
+        bool valid = true;
+
+        const char* field = line;
+        for (int column = 0; column < columnField.size() && field <= lineEnd; ++column)
+        {
+            const char* fieldEnd = static_cast<const char*>(std::memchr(field, ',', lineEnd - field));
+            if (fieldEnd == nullptr)
+                fieldEnd = lineEnd;
+
+            const int index = columnField[column];
+            if (index >= 0)
+            {
+                const Token token = trimmed(field, fieldEnd);
+                if (index == TimeField)
+                    valid = parseTime(token, values[TimeField]);
+                else if (token.begin != token.end)
+                    present[index] = parseNumber(token, values[index]);
+                else
+                    present[index] = false;
+                if (!valid)
+                    break;
+            }
+            field = fieldEnd + 1;
+        }
+
+        const double close = values[CloseField];
+        if (!valid || !present[CloseField] || !(close > 0))
+        {
+            ++rejected;
+            continue;
+        }
+
+        // Missing or zero prices stand in as the close, as the API does for thin days
+        Bar bar;
+        bar.time = values[TimeField];
+        bar.open = present[OpenField] && values[OpenField] > 0 ? values[OpenField] : close;
+        bar.high = present[HighField] && values[HighField] > 0 ? values[HighField] : std::max(close, bar.open);
+        bar.low = present[LowField] && values[LowField] > 0 ? values[LowField] : std::min(close, bar.open);
+        bar.close = close;
+        bar.volume = present[VolumeField] ? std::max(0.0, values[VolumeField]) : 0;
+        if (bar.high < bar.low)
+        {
+            ++rejected;
+            continue;
+        }
+
+        series.append(bar);
+    }
+
+    if (rejectedRows != nullptr)
+        *rejectedRows += rejected;
+    return true;
+}
+
+void SeriesImporter::normalize(Series& series)
+{
+    // Vendor files are usually newest first
+    const double* time = series.column(Series::Time);
+    const int n = series.size();
+    if (n > 1 && std::is_sorted(time, time + n, std::greater<double>()))
+    {
+        Series reversed{series.getSymbol()};
+        reversed.reserve(n);
+        for (int i = n - 1; i >= 0; --i)
+            reversed.append(series.bar(i));
+        series = std::move(reversed);
+    }
+    else
+    {
+        series.sortByTime();
+    }
+
+    time = series.column(Series::Time);
+    if (std::adjacent_find(time, time + n) == time + n)
+        return;
+
+    Series unique{series.getSymbol()};
+    unique.reserve(n);
+    for (int i = 0; i < n; ++i)
+    {
+        if (i + 1 < n && time[i + 1] == time[i])
+            continue;
+        unique.append(series.bar(i));
+    }
+    series = std::move(unique);
+}
+
+Series SeriesImporter::splice(const Series& stored, const Series& imported)
+{
+    if (imported.isEmpty())
+        return stored;
+
+    const double* time = stored.column(Series::Time);
+    const int before = static_cast<int>(std::lower_bound(time, time + stored.size(), imported.firstTime()) - time);
+    const int after = static_cast<int>(std::upper_bound(time, time + stored.size(), imported.lastTime()) - time);
+
+    Series result{imported.getSymbol()};
+    result.reserve(before + imported.size() + stored.size() - after);
+    for (int i = 0; i < before; ++i)
+        result.append(stored.bar(i));
+    for (int i = 0; i < imported.size(); ++i)
+        result.append(imported.bar(i));
+    for (int i = after; i < stored.size(); ++i)
+        result.append(stored.bar(i));
+    return result;
+}
+
+QStringList SeriesImporter::symbolsIn(const QString& directory)
+{
+    QStringList symbols;
+    for (const QFileInfo& info : importFiles(directory))
+        symbols.append(info.completeBaseName().toUpper());
+    return symbols;
+}
+
+ImportReport SeriesImporter::importDirectory(const QString& directory) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    ImportReport report;
+    const QFileInfoList files = importFiles(directory);
+    report.files = files.size();
+
+    std::atomic<int> next{ 0 };
+    std::atomic<int> done{ 0 };
+    std::mutex mutex;
+
+    const auto worker = [&]()
+    {
+        ImportReport local;
+        for (int index = next++; index < files.size(); index = next++)
+        {
+            if (cancelled != nullptr && cancelled->load())
+                break;
+
+            const QFileInfo& info = files[index];
+            const QString symbol = info.completeBaseName().toUpper();
+            QString error;
+
+            if (info.suffix().compare("parquet", Qt::CaseInsensitive) == 0)
+            {
+                ++local.unsupported;
+                error = "Parquet is not supported by this build; convert it to CSV";
+            }
+            else
+            {
+                QFile file(info.filePath());
+                const uchar* data = nullptr;
+                if (!file.open(QIODevice::ReadOnly))
+                    error = file.errorString();
+                else if (file.size() == 0 || (data = file.map(0, file.size())) == nullptr)
+                    error = file.size() == 0 ? "empty file" : "cannot map file";
+
+                Series series{symbol};
+                if (data != nullptr
+                    && parseCsv(reinterpret_cast<const char*>(data), file.size(), series, &local.rejectedRows, &error))
+                {
+                    local.bytes += file.size();
+                    file.unmap(const_cast<uchar*>(data));
+                    normalize(series);
+
+                    const int importedRows = series.size();
+                    if (importedRows > 0 && mergeExisting && store->contains(symbol))
+                    {
+                        const SeriesPtr existing = store->load(symbol);
+                        if (!existing.isNull())
+                            series = splice(*existing, series);
+                    }
+
+                    if (importedRows == 0)
+                        error = "no valid rows";
+                    else if (!store->save(series))
+                        error = "cannot write to the store";
+                    else
+                    {
+                        ++local.imported;
+                        local.rows += importedRows;
+                        local.symbols.append(symbol);
+                    }
+                }
+            }
+
+            if (!error.isEmpty())
+            {
+                ++local.failed;
+                local.errors.append(info.fileName() + ": " + error);
+            }
+            if (progress)
+                progress(++done, files.size());
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        report.imported += local.imported;
+        report.failed += local.failed;
+        report.unsupported += local.unsupported;
+        report.rows += local.rows;
+        report.rejectedRows += local.rejectedRows;
+        report.bytes += local.bytes;
+        report.symbols += local.symbols;
+        report.errors += local.errors;
+    };
+
+    const int threads = std::min<int>(threadCount > 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency()),
+                                       std::max(1, static_cast<int>(files.size())));
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread& thread : pool)
+        thread.join();
+
+    report.symbols.sort();
+    report.errors.sort();
+    report.seconds = timer.nsecsElapsed() / 1e9;
+    return report;
+}
+
+}
@@ -0,0 +1,114 @@
+#ifndef SERIESIMPORTER_HPP
+#define SERIESIMPORTER_HPP
+
+#include <atomic>
+#include <functional>
+
+#include <QString>
+#include <QStringList>
+
+#include "Series.hpp"
+#include "SeriesStore.hpp"
+
+namespace sv
+{
+
+struct ImportReport
+{
+    int files = 0;                   // files found, supported or not
+    int imported = 0;
+    int failed = 0;
+    int unsupported = 0;             // e.g. Parquet, which this build has no reader for
+    qint64 rows = 0;                 // valid rows imported from the files, not counting stored ones kept
+    qint64 rejectedRows = 0;         // rows dropped because they did not parse or validate
+    qint64 bytes = 0;                // size of the files read
+    double seconds = 0;
+    QStringList symbols;             // imported symbols
+    QStringList errors;              // "file: reason"
+
+    double rowsPerSecond() const
+    {
+        return seconds > 0 ? rows / seconds : 0;
+    }
+
+    double megabytesPerSecond() const
+    {
+        return seconds > 0 ? bytes / 1048576.0 / seconds : 0;
+    }
+};
+
+/**
+ * @brief Bulk import of a directory of per-symbol CSV files into a SeriesStore.
+ *
+ * Each file is named after its symbol (AAPL.csv, BRK.B.csv) and starts with a
+ * header row naming its columns. A date or timestamp column and a close (or
+ * price) column are required; open, high, low and volume are optional. Dates
+ * are yyyy-MM-dd, optionally followed by a time of day, or Unix seconds.
+ *
+ * Files are parsed straight from a memory map, one file per worker thread at
+ * a time. Rows that do not parse, have a non-positive close or a high below
+ * the low are dropped and counted. Each series is sorted and de-duplicated
+ * once, then written with a single store save.
+ */
+class SeriesImporter
+{
+public:
+    // Called from the worker threads after each file
+    using Progress = std::function<void(int done, int total)>;
+
+    explicit SeriesImporter(const SeriesStore* store);
+
+    // 0 uses every core
+    void setThreadCount(int count)
+    {
+        threadCount = count;
+    }
+
+    // Keep stored bars outside the imported time range, so a more recent
+    // download is not overwritten by an older vendor file
+    void setMergeExisting(bool merge)
+    {
+        mergeExisting = merge;
+    }
+
+    void setProgress(Progress progress)
+    {
+        this->progress = std::move(progress);
+    }
+
+    // Once set, workers finish the file they are on and take no more
+    void setCancelFlag(const std::atomic<bool>* cancelled)
+    {
+        this->cancelled = cancelled;
+    }
+
+    ImportReport importDirectory(const QString& directory) const;
+
+    // The symbols importDirectory would write, from the file names alone
+    static QStringList symbolsIn(const QString& directory);
+
+    /**
+     * @brief Parse CSV text into `series`, unsorted.
+     * @return False if the header lacks a date or close column.
+     */
+    static bool parseCsv(const char* data, qint64 size, Series& series, qint64* rejectedRows = nullptr,
+                         QString* error = nullptr);
+
+    // Sort by time and keep the last of any rows sharing a timestamp
+    static void normalize(Series& series);
+
+    // Stored bars before the first imported bar, the imported bars, then
+    // stored bars after the last imported bar; both inputs sorted
+    static Series splice(const Series& stored, const Series& imported);
+
+private:
+    const SeriesStore* store;
+    int threadCount = 0;
+    bool mergeExisting = true;
+    Progress progress;
+    const std::atomic<bool>* cancelled = nullptr;
+};
+
+}
+
+#endif // SERIESIMPORTER_HPP
@@ -0,0 +1,173 @@
+#include <QFileInfo>
+
+#include "SeriesManager.hpp"
+
+namespace sv
+{
+
+SeriesManager::SeriesManager(qint64 budgetBytes)
+    : budget(budgetBytes)
+{
+}
+
+void SeriesManager::setBudget(qint64 budgetBytes)
+{
+    budget = budgetBytes;
+    evict();
+}
+
+qint64 SeriesManager::footprint(const Series& series)
+{
+    return static_cast<qint64>(series.size()) * Series::ColumnCount * sizeof(double)
+        + series.getSymbol().size() * sizeof(QChar);
+}
+
+void SeriesManager::touch(const QString& symbol, Entry& entry)
+{
+    lastUsed = symbol;
+
+    const bool evictable = !entry.resident.isNull() && entry.persisted;
+    if (entry.queued && evictable)
+    {
+        evictionOrder.splice(evictionOrder.end(), evictionOrder, entry.position);
+    }
+    else if (entry.queued)
+    {
+        evictionOrder.erase(entry.position);
+        entry.queued = false;
+    }
+    else if (evictable)
+    {
+        entry.position = evictionOrder.insert(evictionOrder.end(), symbol);
+        entry.queued = true;
+    }
+}
+
+void SeriesManager::insert(const SeriesPtr& series, bool persisted)
+{
+    if (series.isNull())
+        return;
+
+    const QString symbol = series->getSymbol();
+    Entry& entry = entries[symbol];
+    if (!entry.resident.isNull())
+        residentBytes -= entry.bytes;
+
+    entry.resident = series;
+    entry.evicted.clear();
+    entry.bytes = footprint(*series);
+    entry.persisted = persisted;
+    residentBytes += entry.bytes;
+    touch(symbol, entry);
+    evict();
+}
+
+SeriesPtr SeriesManager::get(const QString& symbol)
+{
+    auto it = entries.find(symbol);
+    if (it == entries.end())
+    {
+        const SeriesPtr stored = store != nullptr ? store->load(symbol) : SeriesPtr();
+        insert(stored);
+        return stored;
+    }
+
+    Entry& entry = it.value();
+    if (!entry.resident.isNull())
+    {
+        touch(symbol, entry);
+        return entry.resident;
+    }
+
+    SeriesPtr series = entry.evicted.toStrongRef();
+    if (series.isNull() && store != nullptr)
+        series = store->load(symbol);
+    if (series.isNull())
+        return series;
+
+    entry.resident = series;
+    entry.evicted.clear();
+    entry.bytes = footprint(*series);
+    residentBytes += entry.bytes;
+    touch(symbol, entry);
+    evict();
+    return series;
+}
+
+SeriesPtr SeriesManager::peek(const QString& symbol) const
+{
+    const auto it = entries.constFind(symbol);
+    if (it == entries.constEnd())
+        return SeriesPtr();
+    return !it->resident.isNull() ? it->resident : it->evicted.toStrongRef();
+}
+
+bool SeriesManager::isPinned(const QString& symbol) const
+{
+    const auto it = entries.constFind(symbol);
+    return it != entries.constEnd() && !it->resident.isNull() && !it->persisted;
+}
+
+bool SeriesManager::isResident(const QString& symbol) const
+{
+    const auto it = entries.constFind(symbol);
+    return it != entries.constEnd() && !it->resident.isNull();
+}
+
+void SeriesManager::remove(const QString& symbol)
+{
+    const auto it = entries.find(symbol);
+    if (it == entries.end())
+        return;
+
+    if (!it->resident.isNull())
+        residentBytes -= it->bytes;
+    if (it->queued)
+        evictionOrder.erase(it->position);
+    entries.erase(it);
+}
+
+SeriesMemoryUsage SeriesManager::usage() const
+{
+    SeriesMemoryUsage usage;
+    for (const Entry& entry : entries)
+    {
+        if (!entry.resident.isNull())
+        {
+            usage.residentBytes += entry.bytes;
+            if (!entry.persisted)
+                usage.pinnedBytes += entry.bytes;
+            ++usage.residentCount;
+            continue;
+        }
+
+        ++usage.evictedCount;
+        if (!entry.evicted.toStrongRef().isNull())
+            usage.sharedBytes += entry.bytes;
+        else
+            usage.mappedBytes += entry.fileBytes;
+    }
+    return usage;
+}
+
+void SeriesManager::evict()
+{
+    // The most recently used series stays even if it alone exceeds the budget.
+    // Versions the store does not have are pinned: saving them would persist
+    // provisional bars, and dropping them would lose them, so they are never
+    // queued and the front of the queue is always the one to go.
+    while (residentBytes > budget && !evictionOrder.empty() && evictionOrder.front() != lastUsed)
+    {
+        const QString symbol = evictionOrder.front();
+        evictionOrder.pop_front();
+
+        Entry& coldest = entries[symbol];
+        coldest.queued = false;
+        coldest.fileBytes = store != nullptr ? QFileInfo(store->pathFor(symbol)).size() : 0;
+        coldest.evicted = coldest.resident;
+        coldest.resident.reset();
+        residentBytes -= coldest.bytes;
+    }
+}
+
+}
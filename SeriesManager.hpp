@@ -0,0 +1,120 @@
+#ifndef SERIESMANAGER_HPP
+#define SERIESMANAGER_HPP
+
+#include <list>
+
+#include <QHash>
+#include <QStringList>
+#include <QWeakPointer>
+
+#include "Series.hpp"
+#include "SeriesStore.hpp"
+
+namespace sv
+{
+
+struct SeriesMemoryUsage
+{
+    qint64 residentBytes = 0;        // series the manager keeps in memory, pinned ones included
+    qint64 pinnedBytes = 0;          // versions the store does not have, which cannot be evicted
+    qint64 sharedBytes = 0;          // evicted series still referenced elsewhere, e.g. by the chart
+    qint64 mappedBytes = 0;          // store files backing the other evicted series
+    int residentCount = 0;
+    int evictedCount = 0;
+};
+
+/**
+ * @brief The in-memory series of every open symbol, kept within a memory budget.
+ *
+ * The most recently used series stay resident. Once their total size exceeds
+ * the budget, the least recently used are evicted by dropping the manager's
+ * reference. Versions the store does not have, such as a series extended by
+ * a provisional quote, are never evicted; they stay pinned until replaced by
+ * a persisted version. get() pages
+ * an evicted series back in transparently. If something else still holds it
+ * (the chart, a replay), the existing copy is picked up again through a weak
+ * reference; otherwise it is decoded from the store's memory-mapped file.
+ */
+class SeriesManager
+{
+public:
+    static constexpr qint64 defaultBudget = 256ll << 20;
+
+    explicit SeriesManager(qint64 budgetBytes = defaultBudget);
+
+    void setStore(const SeriesStore* store)
+    {
+        this->store = store;
+    }
+
+    void setBudget(qint64 budgetBytes);
+
+    qint64 getBudget() const
+    {
+        return budget;
+    }
+
+    /**
+     * @brief Make `series` the current version for its symbol.
+     * @param persisted False if the store does not have this version, e.g. one
+     *                  extended by a provisional quote; it is kept resident.
+     */
+    void insert(const SeriesPtr& series, bool persisted = true);
+
+    // The current version, paged in from the store if needed; null if there is none
+    SeriesPtr get(const QString& symbol);
+
+    // The current version if it is still in memory, without paging it in or
+    // counting as a use; null otherwise
+    SeriesPtr peek(const QString& symbol) const;
+
+    // Resident or evicted; symbols only in the store are not counted
+    bool contains(const QString& symbol) const
+    {
+        return entries.contains(symbol);
+    }
+
+    bool isResident(const QString& symbol) const;
+
+    // Resident in a version the store does not have, e.g. one extended by a quote
+    bool isPinned(const QString& symbol) const;
+
+    void remove(const QString& symbol);
+
+    QStringList symbols() const
+    {
+        return entries.keys();
+    }
+
+    SeriesMemoryUsage usage() const;
+
+    // Heap bytes held by the series' columns
+    static qint64 footprint(const Series& series);
+
+private:
+    struct Entry
+    {
+        SeriesPtr resident;
+        QWeakPointer<const Series> evicted;
+        qint64 bytes = 0;
+        qint64 fileBytes = 0;        // size of the store file, once evicted
+        bool persisted = true;
+        bool queued = false;         // in evictionOrder at `position`
+        std::list<QString>::iterator position;
+    };
+
+    // Mark the entry most recently used and requeue it if it can be evicted
+    void touch(const QString& symbol, Entry& entry);
+    void evict();
+
+    const SeriesStore* store = nullptr;
+    qint64 budget;
+    qint64 residentBytes = 0;
+    QString lastUsed;
+    QHash<QString, Entry> entries;
+    std::list<QString> evictionOrder; // resident, persisted series, least recently used first
+};
+
+}
+
+#endif // SERIESMANAGER_HPP
@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <limits>
+
+#include <QMetaObject>
+
+#include "Indicators.hpp"
+#include "SeriesPipeline.hpp"
+#include "StockParser.hpp"
+
+namespace sv
+{
+
+namespace
+{
+
+bool sameBars(const Series& a, const Series& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (int column = 0; column < Series::ColumnCount; ++column)
+    {
+        const double* values = a.column(static_cast<Series::Column>(column));
+        if (!std::equal(values, values + a.size(), b.column(static_cast<Series::Column>(column))))
+            return false;
+    }
+    return true;
+}
+
+}
+
+SeriesPipeline::SeriesPipeline(int parseWorkers, int queueCapacity, QObject* parent)
+    : QObject(parent),
+      storeQueue(queueCapacity)
+{
+    if (parseWorkers > 0)
+        parsePool.setMaxThreadCount(parseWorkers);
+
+    storeThread = std::thread(&SeriesPipeline::storeLoop, this);
+}
+
+SeriesPipeline::~SeriesPipeline()
+{
+    // Parsers may be waiting on a full store queue, so drain them before closing it
+    parsePool.waitForDone();
+    storeQueue.close();
+    storeThread.join();
+}
+
+int SeriesPipeline::beginStream(const QString& symbol)
+{
+    ++pending;
+
+    QSharedPointer<Stream> stream = QSharedPointer<Stream>::create();
+    stream->result.symbol = symbol;
+
+    const int streamId = nextStreamId++;
+    streams.insert(streamId, stream);
+    return streamId;
+}
+
+void SeriesPipeline::feedStream(int streamId, const QByteArray& chunk)
+{
+    const QSharedPointer<Stream> stream = streams.value(streamId);
+    if (stream.isNull() || chunk.isEmpty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->chunks.push_back(chunk);
+    }
+    schedule(stream);
+}
+
+void SeriesPipeline::endStream(int streamId)
+{
+    const QSharedPointer<Stream> stream = streams.take(streamId);
+    if (stream.isNull())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->ended = true;
+    }
+    schedule(stream);
+}
+
+void SeriesPipeline::abortStream(int streamId)
+{
+    const QSharedPointer<Stream> stream = streams.take(streamId);
+    if (stream.isNull())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->aborted = true;
+        stream->chunks.clear();
+    }
+    --pending;
+}
+
+void SeriesPipeline::schedule(const QSharedPointer<Stream>& stream)
+{
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        if (stream->scheduled)
+            return;
+        stream->scheduled = true;
+    }
+
+    parsePool.start([this, stream]() { drain(stream); });
+}
+
+void SeriesPipeline::drain(const QSharedPointer<Stream>& stream)
+{
+    for (;;)
+    {
+        QByteArray chunk;
+        {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            if (stream->aborted)
+            {
+                stream->scheduled = false;
+                return;
+            }
+            if (stream->chunks.empty())
+            {
+                stream->scheduled = false;
+                if (!stream->ended || stream->finished)
+                    return;
+                // Ended and fully consumed; later drains of this stream return above
+                stream->finished = true;
+                break;
+            }
+            chunk = std::move(stream->chunks.front());
+            stream->chunks.pop_front();
+        }
+
+        stream->parser.feed(chunk.constData(), chunk.size());
+    }
+
+    finishStream(*stream);
+}
+
+void SeriesPipeline::finishStream(Stream& stream)
+{
+    PipelineResult result = std::move(stream.result);
+
+    if (!stream.parser.finish())
+    {
+        result.error = stream.parser.getError();
+        QMetaObject::invokeMethod(this, [this, result]() { complete(result); }, Qt::QueuedConnection);
+        return;
+    }
+
+    QSharedPointer<Series> series = QSharedPointer<Series>::create(stream.parser.takeSeries());
+    if (!series->getSymbol().isEmpty())
+        result.symbol = series->getSymbol();
+    else
+        series->setSymbol(result.symbol);
+
+    result.data.series = series;
+    result.data.points = series->toPoints();
+    result.data.labels = priceLabels(result.symbol);
+
+    storeQueue.push(std::move(result));
+}
+
+void SeriesPipeline::holdSymbols(const QStringList& symbols)
+{
+    std::unique_lock<std::mutex> lock(holdMutex);
+    for (const QString& symbol : symbols)
+        heldSymbols.insert(symbol);
+    storeFinished.wait(lock, [this]() { return !heldSymbols.contains(storingSymbol); });
+}
+
+void SeriesPipeline::releaseSymbols(const QStringList& symbols)
+{
+    QVector<PipelineResult> released;
+    {
+        std::lock_guard<std::mutex> lock(holdMutex);
+        for (const QString& symbol : symbols)
+            heldSymbols.remove(symbol);
+
+        for (auto it = heldResults.begin(); it != heldResults.end();)
+        {
+            if (heldSymbols.contains(it->symbol))
+            {
+                ++it;
+                continue;
+            }
+            released.append(*it);
+            it = heldResults.erase(it);
+        }
+    }
+
+    // Back through the store stage, now merging with what the holder wrote
+    for (const PipelineResult& result : released)
+        storeQueue.push(result);
+}
+
+void SeriesPipeline::storeLoop()
+{
+    PipelineResult result;
+    while (storeQueue.pop(result))
+    {
+        {
+            std::lock_guard<std::mutex> lock(holdMutex);
+            if (heldSymbols.contains(result.symbol))
+            {
+                heldResults.append(result);
+                continue;
+            }
+            storingSymbol = result.symbol;
+        }
+
+        // Only the stored blocks from the fetched range on are decoded first; a
+        // refresh that brought nothing new then costs neither a full decode nor a write
+        if (store != nullptr && !result.data.series->isEmpty())
+        {
+            const Series& fetched = *result.data.series;
+            const SeriesPtr overlap = store->load(result.symbol, fetched.firstTime(), std::numeric_limits<double>::infinity());
+            result.unchanged = !overlap.isNull() && sameBars(*overlap, fetched);
+        }
+
+        if (store != nullptr && !result.unchanged)
+        {
+            const SeriesPtr cached = store->load(result.symbol);
+            if (!cached.isNull())
+            {
+                QSharedPointer<Series> merged = QSharedPointer<Series>::create(Series::merge(*cached, *result.data.series));
+                result.data.series = merged;
+                result.data.points = merged->toPoints();
+            }
+            store->save(*result.data.series);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(holdMutex);
+            storingSymbol.clear();
+        }
+        storeFinished.notify_all();
+
+        // Snapshot of the indicators SimpleAnalysis.py reports, using the O(1) incremental forms
+        if (!result.unchanged)
+        {
+            IndicatorSnapshot indicators;
+            const Series& series = *result.data.series;
+            const double* close = series.column(Series::Close);
+            for (int i = 0; i < series.size(); ++i)
+                indicators.push(close[i]);
+            result.indicators = indicators.values();
+        }
+
+        QMetaObject::invokeMethod(this, [this, result]() { complete(result); }, Qt::QueuedConnection);
+    }
+}
+
+void SeriesPipeline::complete(const PipelineResult& result)
+{
+    --pending;
+
+    if (result.error.isEmpty())
+        emit seriesReady(result);
+    else
+        emit failed(result.symbol, result.error);
+}
+
+}
@@ -0,0 +1,144 @@
+#ifndef SERIESPIPELINE_HPP
+#define SERIESPIPELINE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QSharedPointer>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+#include "BoundedQueue.hpp"
+#include "QtUtils.hpp"
+#include "SeriesStore.hpp"
+#include "StreamingStockParser.hpp"
+
+namespace sv
+{
+
+struct PipelineResult
+{
+    QString symbol;
+    QString error;
+    StockDataResult data;
+    QMap<QString, double> indicators;
+    // The store already had exactly the fetched bars, so nothing was written;
+    // data then holds only those bars and there is no indicator snapshot
+    bool unchanged = false;
+};
+
+/**
+ * @brief Turns raw network payloads into finished, immutable series off the
+ *        GUI thread.
+ *
+ * Stages: parse (a pool of workers) -> store (one thread merging into the
+ * series store and computing the indicator snapshot) -> back on the owning thread via
+ * seriesReady(). The stages are joined by a bounded queue, and inFlight()
+ * lets the fetcher cap how much work is admitted in the first place.
+ *
+ * Responses may be streamed: chunks fed to a stream are parsed in order on the
+ * worker pool while the rest is still downloading, so by the time the reply
+ * finishes only the tail remains to be parsed.
+ */
+class SeriesPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param parseWorkers  Parser threads; 0 uses the ideal thread count.
+     * @param queueCapacity Parsed results allowed to wait for the store stage.
+     */
+    explicit SeriesPipeline(int parseWorkers = 0, int queueCapacity = 4, QObject* parent = nullptr);
+    ~SeriesPipeline();
+
+    /**
+     * @brief Start an incremental parse; returns the id to feed chunks to.
+     *        Call from the thread that owns the pipeline.
+     */
+    int beginStream(const QString& symbol);
+
+    void feedStream(int streamId, const QByteArray& chunk);
+
+    // No more chunks; the parsed series continues to the store stage
+    void endStream(int streamId);
+
+    // Drop a stream whose download failed
+    void abortStream(int streamId);
+
+    int inFlight() const
+    {
+        return pending;
+    }
+
+    /**
+     * @brief Splice downloaded bars onto the cached history in the store and
+     *        persist the result. Set before starting streams.
+     */
+    void setStore(const SeriesStore* store)
+    {
+        this->store = store;
+    }
+
+    /**
+     * @brief Stop writing the symbols' store files, e.g. while a bulk import
+     *        owns them. Waits for a write already under way to finish;
+     *        results for held symbols wait until they are released.
+     */
+    void holdSymbols(const QStringList& symbols);
+
+    void releaseSymbols(const QStringList& symbols);
+
+signals:
+    void seriesReady(const sv::PipelineResult& result);
+    void failed(const QString& symbol, const QString& error);
+
+private:
+    // Chunks of one response, parsed strictly in order by at most one worker at a time
+    struct Stream
+    {
+        std::mutex mutex;
+        std::deque<QByteArray> chunks;
+        bool scheduled = false;
+        bool ended = false;
+        bool finished = false;
+        bool aborted = false;
+        StreamingStockParser parser;
+        PipelineResult result;
+    };
+
+    void schedule(const QSharedPointer<Stream>& stream);
+    void drain(const QSharedPointer<Stream>& stream);
+    void finishStream(Stream& stream);
+    void storeLoop();
+    void complete(const PipelineResult& result);
+
+    QHash<int, QSharedPointer<Stream>> streams;
+    int nextStreamId = 1;
+
+    QThreadPool parsePool;
+    BoundedQueue<PipelineResult> storeQueue;
+    std::thread storeThread;
+    int pending = 0;
+    const SeriesStore* store = nullptr;
+
+    // Guards the hold state shared between the owning thread and the store thread
+    std::mutex holdMutex;
+    std::condition_variable storeFinished;
+    QSet<QString> heldSymbols;
+    QVector<PipelineResult> heldResults;
+    QString storingSymbol;           // symbol the store thread is writing, if any
+};
+
+}
+
+#endif // SERIESPIPELINE_HPP
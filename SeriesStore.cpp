@@ -0,0 +1,139 @@
+#include <cstring>
+#include <limits>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "SeriesCodec.hpp"
+#include "SeriesStore.hpp"
+
+namespace sv
+{
+
+namespace
+{
+
+// Uncompressed files written by earlier versions are still read
+const char storeMagic[4] = { 'S', 'V', 'S', '1' };
+const QString storeSuffix = QStringLiteral(".svs");
+
+struct StoreHeader
+{
+    char magic[4];
+    quint32 columnCount;
+    qint64 rowCount;
+};
+
+// Symbols become file names; keep them to a safe character set
+QString fileNameFor(const QString& symbol)
+{
+    QString name = symbol.toUpper();
+    for (QChar& c : name)
+    {
+        if (!c.isLetterOrNumber() && c != '.' && c != '-' && c != '^')
+            c = '_';
+    }
+    return name;
+}
+
+}
+
+SeriesStore::SeriesStore(const QString& directory)
+    : directory(directory)
+{
+    QDir().mkpath(directory);
+}
+
+QString SeriesStore::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/series");
+}
+
+QString SeriesStore::pathFor(const QString& symbol) const
+{
+    return QDir(directory).filePath(fileNameFor(symbol) + storeSuffix);
+}
+
+bool SeriesStore::contains(const QString& symbol) const
+{
+    return QFileInfo::exists(pathFor(symbol));
+}
+
+SeriesPtr SeriesStore::load(const QString& symbol) const
+{
+    return load(symbol, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+}
+
+SeriesPtr SeriesStore::load(const QString& symbol, double from, double to) const
+{
+    QFile file(pathFor(symbol));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < static_cast<qint64>(sizeof(StoreHeader)))
+        return SeriesPtr();
+
+    // Mapping keeps a range query from reading blocks it does not decode
+    const uchar* data = file.map(0, file.size());
+    if (data == nullptr)
+        return SeriesPtr();
+
+    QSharedPointer<Series> series = QSharedPointer<Series>::create(symbol.toUpper());
+    const bool valid = SeriesCodec::isArchive(reinterpret_cast<const char*>(data), file.size())
+        ? SeriesCodec::decode(reinterpret_cast<const char*>(data), file.size(), *series, from, to)
+        : loadUncompressed(data, file.size(), *series, from, to);
+
+    file.unmap(const_cast<uchar*>(data));
+    return valid ? series : SeriesPtr();
+}
+
+bool SeriesStore::loadUncompressed(const uchar* data, qint64 size, Series& series, double from, double to)
+{
+    StoreHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    const qint64 expectedSize = static_cast<qint64>(sizeof(StoreHeader))
+        + header.rowCount * static_cast<qint64>(Series::ColumnCount * sizeof(double));
+    if (std::memcmp(header.magic, storeMagic, sizeof(storeMagic)) != 0
+        || header.columnCount != Series::ColumnCount || header.rowCount < 0 || size != expectedSize)
+        return false;
+
+    const int rows = static_cast<int>(header.rowCount);
+    const double* columns = reinterpret_cast<const double*>(data + sizeof(StoreHeader));
+
+    series.reserve(rows);
+    for (int i = 0; i < rows; ++i)
+    {
+        if (columns[i] < from || columns[i] > to)
+            continue;
+        series.append(Bar{ columns[i], columns[rows + i], columns[2 * rows + i],
+                           columns[3 * rows + i], columns[4 * rows + i], columns[5 * rows + i] });
+    }
+    return true;
+}
+
+bool SeriesStore::save(const Series& series) const
+{
+    QSaveFile file(pathFor(series.getSymbol()));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(SeriesCodec::encode(series));
+    return file.commit();
+}
+
+bool SeriesStore::remove(const QString& symbol) const
+{
+    return QFile::remove(pathFor(symbol));
+}
+
+QStringList SeriesStore::symbols() const
+{
+    QStringList result;
+    const QFileInfoList entries = QDir(directory).entryInfoList({ "*" + storeSuffix }, QDir::Files, QDir::Name);
+    for (const QFileInfo& entry : entries)
+        result << entry.completeBaseName();
+    return result;
+}
+
+}
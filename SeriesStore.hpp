@@ -0,0 +1,57 @@
+#ifndef SERIESSTORE_HPP
+#define SERIESSTORE_HPP
+
+#include <QString>
+#include <QtGlobal>
+#include <QStringList>
+
+#include "Series.hpp"
+
+namespace sv
+{
+
+/**
+ * @brief On-disk cache of series, one file per symbol.
+ *
+ * Files use the compressed SeriesCodec archive format and are read through a
+ * memory map, so a range query only touches the blocks it decodes. Files in
+ * the older uncompressed layout are still read. Writes go through QSaveFile
+ * and are atomic. The store keeps no in-memory state and may be used from any thread.
+ */
+class SeriesStore
+{
+public:
+    explicit SeriesStore(const QString& directory = defaultDirectory());
+
+    static QString defaultDirectory();
+
+    QString getDirectory() const
+    {
+        return directory;
+    }
+
+    bool contains(const QString& symbol) const;
+
+    // The cached series, or null if there is none or the file is unreadable
+    SeriesPtr load(const QString& symbol) const;
+
+    // Only the bars with from <= time <= to
+    SeriesPtr load(const QString& symbol, double from, double to) const;
+
+    bool save(const Series& series) const;
+
+    bool remove(const QString& symbol) const;
+
+    QStringList symbols() const;
+
+    QString pathFor(const QString& symbol) const;
+
+private:
+    static bool loadUncompressed(const uchar* data, qint64 size, Series& series, double from, double to);
+
+    QString directory;
+};
+
+}
+
+#endif // SERIESSTORE_HPP
@@ -0,0 +1,102 @@
+#ifndef SESSIONSTATE_HPP
+#define SESSIONSTATE_HPP
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QString>
+
+#include "QtUtils.hpp"
+
+namespace sv
+{
+
+// What the window restores on the next launch, before any network or Python work
+struct SessionState
+{
+    QString tickerSymbols;
+    QString displayedSymbol;
+    double viewFrom = 0;             // chart zoom; equal bounds show the whole series
+    double viewTo = 0;
+    QString scriptPath;
+    QString arguments;
+    AnalysisResult analysis;         // overlays, annotations and output of the last run
+
+    static QString defaultPath()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/session.dat");
+    }
+
+    bool save(const QString& path = defaultPath()) const
+    {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        QDataStream stream(&file);
+        stream << magic << version;
+        stream << tickerSymbols << displayedSymbol << viewFrom << viewTo << scriptPath << arguments;
+
+        // Only what is drawn is kept; the full series come from the store
+        stream << analysis.exitCode << analysis.output << analysis.metrics;
+        stream << qint32(analysis.series.size());
+        for (const StockDataResult& series : analysis.series)
+            stream << series.points << series.labels;
+        stream << qint32(analysis.annotations.size());
+        for (const Annotation& annotation : analysis.annotations)
+            stream << annotation.timestamp << annotation.text;
+
+        return stream.status() == QDataStream::Ok && file.commit();
+    }
+
+    // A default state if there is no session yet or it cannot be read
+    static SessionState load(const QString& path = defaultPath())
+    {
+        SessionState state;
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            return state;
+
+        QDataStream stream(&file);
+        quint32 fileMagic = 0;
+        quint32 fileVersion = 0;
+        stream >> fileMagic >> fileVersion;
+        if (fileMagic != magic || fileVersion != version)
+            return state;
+
+        SessionState loaded;
+        stream >> loaded.tickerSymbols >> loaded.displayedSymbol >> loaded.viewFrom >> loaded.viewTo
+               >> loaded.scriptPath >> loaded.arguments;
+        stream >> loaded.analysis.exitCode >> loaded.analysis.output >> loaded.analysis.metrics;
+
+        qint32 count = 0;
+        stream >> count;
+        for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+        {
+            StockDataResult series;
+            stream >> series.points >> series.labels;
+            loaded.analysis.series.append(series);
+        }
+
+        stream >> count;
+        for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+        {
+            Annotation annotation;
+            stream >> annotation.timestamp >> annotation.text;
+            loaded.analysis.annotations.append(annotation);
+        }
+
+        return stream.status() == QDataStream::Ok ? loaded : state;
+    }
+
+private:
+    static constexpr quint32 magic = 0x53565353;   // "SVSS"
+    static constexpr quint32 version = 1;
+};
+
+}
+
+#endif // SESSIONSTATE_HPP
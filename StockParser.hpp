@@ -0,0 +1,192 @@
+#ifndef STOCKPARSER_HPP
+#define STOCKPARSER_HPP
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+#include "QtUtils.hpp"
+#include "Series.hpp"
+
+// Conversions between StockDataResult and the JSON/CSV formats StockView reads
+// and writes. These are free functions with no shared state so the fetch
+// pipeline can call them from worker threads.
+
+namespace sv
+{
+
+// Chart labels for a symbol's daily price history
+inline QMap<QString, QString> priceLabels(const QString& symbol)
+{
+    return {
+        {"x_axis", "Date"},
+        {"y_axis", "Price (USD)"},
+        {"legend", symbol + " Stock Price"},
+        {"title", symbol + " Daily Stock Prices"}
+    };
+}
+
+// One JSON quote field; bulk endpoints send numbers either bare or as strings
+inline double quoteNumber(const QJsonValue& value)
+{
+    return value.isString() ? value.toString().toDouble() : value.toDouble();
+}
+
+// The trading day of a "yyyy-MM-dd[ hh:mm:ss...]" quote timestamp, at the same
+// local midnight the daily series use; 0 if it does not parse
+inline double quoteDay(const QString& timestamp)
+{
+    const QDate date = QDate::fromString(timestamp.trimmed().left(10), "yyyy-MM-dd");
+    return date.isValid() ? static_cast<double>(date.startOfDay().toSecsSinceEpoch()) : 0;
+}
+
+/**
+ * @brief Split a bulk quote response into one daily bar per symbol.
+ *
+ * Accepts the JSON form ({"data": [{"symbol": ..., "timestamp": ..., "open":
+ * ..., ...}, ...]}) and the datatype=csv form with a header row. Symbols are
+ * upper-cased. On an API error message the result is empty and the message is
+ * stored in `error`.
+ */
+inline QMap<QString, Bar> parseBulkQuotes(const QByteArray& data, QString* error = nullptr)
+{
+    QMap<QString, Bar> quotes;
+    const QByteArray trimmed = data.trimmed();
+
+    if (trimmed.startsWith('{'))
+    {
+        const QJsonObject root = QJsonDocument::fromJson(trimmed).object();
+        for (const char* key : { "Error Message", "Note", "Information" })
+        {
+            if (root.contains(key) && !root.contains("data"))
+            {
+                if (error != nullptr)
+                    *error = root.value(key).toString();
+                return quotes;
+            }
+        }
+
+        for (const QJsonValue& value : root.value("data").toArray())
+        {
+            const QJsonObject quote = value.toObject();
+            const QString symbol = quote.value("symbol").toString().trimmed().toUpper();
+            const double time = quoteDay(quote.value("timestamp").toString());
+            if (symbol.isEmpty() || time <= 0)
+                continue;
+
+            quotes.insert(symbol, Bar{ time, quoteNumber(quote.value("open")), quoteNumber(quote.value("high")),
+                                       quoteNumber(quote.value("low")), quoteNumber(quote.value("close")),
+                                       quoteNumber(quote.value("volume")) });
+        }
+        return quotes;
+    }
+
+    const QList<QByteArray> lines = trimmed.split('\n');
+    const QList<QByteArray> header = lines.value(0).trimmed().toLower().split(',');
+    const int symbolColumn = header.indexOf("symbol");
+    const int timeColumn = header.indexOf("timestamp");
+    const int columns[] = { header.indexOf("open"), header.indexOf("high"), header.indexOf("low"),
+                            header.indexOf("close"), header.indexOf("volume") };
+    if (symbolColumn < 0 || timeColumn < 0 || columns[3] < 0)
+    {
+        if (error != nullptr)
+            *error = QString::fromUtf8(trimmed.left(200));
+        return quotes;
+    }
+
+    for (int i = 1; i < lines.size(); ++i)
+    {
+        const QList<QByteArray> fields = lines[i].trimmed().split(',');
+        const QString symbol = QString::fromUtf8(fields.value(symbolColumn)).trimmed().toUpper();
+        const double time = quoteDay(QString::fromUtf8(fields.value(timeColumn)));
+        if (symbol.isEmpty() || time <= 0)
+            continue;
+
+        // A quote without open/high/low is drawn flat at the close
+        const double close = fields.value(columns[3]).toDouble();
+        double values[5];
+        for (int column = 0; column < 5; ++column)
+            values[column] = columns[column] >= 0 ? fields.value(columns[column]).toDouble() : (column < 4 ? close : 0);
+        quotes.insert(symbol, Bar{ time, values[0], values[1], values[2], values[3], values[4] });
+    }
+    return quotes;
+}
+
+inline StockDataResult readStockData(const QString& filename, const QString& symbol)
+{
+    StockDataResult result;
+    result.labels = {
+        {"x_axis", "Date"},
+        {"y_axis", "Price (USD)"},
+        {"legend", "est. " + symbol + " Stock Price"},
+        {"title", symbol + " Daily Stock Prices"}
+    };
+
+    QFile file(filename);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return result;
+
+    QTextStream in(&file);
+
+    // Skip header line
+    QString header = in.readLine();
+
+    // Read data lines
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        QStringList fields = line.split(',');
+
+        if (fields.size() >= 2) {
+            bool okTime, okPrice;
+            double timestamp = fields[0].toDouble(&okTime);
+            double price = fields[1].toDouble(&okPrice);
+
+            if (okTime && okPrice) {
+                result.points.append(QPointF(timestamp, price));
+            }
+        }
+    }
+
+    file.close();
+    return result;
+}
+
+// Write the two-column timestamp,price CSV the Python scripts consume to a
+// temporary file that outlives this call; returns its path or an empty string
+inline QString writeStockDataFile(const StockDataResult& result)
+{
+    QTemporaryFile tempFile;
+    tempFile.setAutoRemove(false); // Don't delete automatically
+
+    if (!tempFile.open())
+    {
+        qDebug() << "Failed to create temporary file";
+        return QString();
+    }
+
+    // Write data to file in CSV format
+    QTextStream stream(&tempFile);
+    stream << "timestamp,price\n"; // Header
+
+    for (const QPointF& point : result.points)
+    {
+        stream << QString::number(point.x()) << ","
+               << QString::number(point.y()) << "\n";
+    }
+
+    stream.flush();
+    const QString path = tempFile.fileName();
+    tempFile.close();
+    return path;
+}
+
+}
+
+#endif // STOCKPARSER_HPP
@@ -0,0 +1,254 @@
+#include <cstdlib>
+#include <cstring>
+
+#include <QByteArray>
+#include <QDate>
+#include <QDateTime>
+
+#include "StreamingStockParser.hpp"
+
+namespace sv
+{
+
+namespace
+{
+
+bool isDelimiter(char c)
+{
+    return c == ',' || c == '}' || c == ']' || c == ':' || c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool startsWith(const std::string& text, const char* prefix)
+{
+    return text.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+// "yyyy-MM-dd" to the same local-midnight timestamp QDateTime::fromString produces
+double dateToTimestamp(const std::string& date)
+{
+    if (date.size() < 10)
+        return 0;
+
+    const int year = std::atoi(date.substr(0, 4).c_str());
+    const int month = std::atoi(date.substr(5, 2).c_str());
+    const int day = std::atoi(date.substr(8, 2).c_str());
+    return static_cast<double>(QDate(year, month, day).startOfDay().toSecsSinceEpoch());
+}
+
+}
+
+void StreamingStockParser::feed(const char* data, int size)
+{
+    for (int i = 0; i < size; ++i)
+    {
+        const char c = data[i];
+
+        switch (state)
+        {
+        case State::String:
+            if (c == '"')
+            {
+                state = State::Value;
+                onToken(true);
+            }
+            else if (c == '\\')
+            {
+                state = State::Escape;
+            }
+            else
+            {
+                token += c;
+            }
+            break;
+
+        case State::Escape:
+            switch (c)
+            {
+            case 'n': token += '\n'; break;
+            case 't': token += '\t'; break;
+            case 'r': token += '\r'; break;
+            case 'b': token += '\b'; break;
+            case 'f': token += '\f'; break;
+            case 'u': token += "\\u"; break;   // kept verbatim; the fields we read are ASCII
+            default: token += c; break;
+            }
+            state = State::String;
+            break;
+
+        case State::Scalar:
+            if (!isDelimiter(c))
+            {
+                token += c;
+                break;
+            }
+            state = State::Value;
+            onToken(false);
+            // The delimiter is structural, handle it below
+            [[fallthrough]];
+
+        case State::Value:
+            switch (c)
+            {
+            case '{': onContainerStart(true); break;
+            case '[': onContainerStart(false); break;
+            case '}':
+            case ']': onContainerEnd(); break;
+            case ',':
+                if (!stack.empty() && stack.back().isObject)
+                    stack.back().expectKey = true;
+                break;
+            case ':':
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                break;
+            case '"':
+                token.clear();
+                state = State::String;
+                break;
+            default:
+                token.assign(1, c);
+                state = State::Scalar;
+                break;
+            }
+            break;
+        }
+    }
+}
+
+bool StreamingStockParser::finish()
+{
+    if (state == State::Scalar)
+    {
+        state = State::Value;
+        onToken(false);
+    }
+
+    if (!stack.empty() || state != State::Value)
+    {
+        if (error.isEmpty())
+            error = QStringLiteral("Truncated response");
+        return false;
+    }
+
+    if (bars.isEmpty() && error.isEmpty())
+        error = QStringLiteral("No valid stock data!");
+
+    return error.isEmpty();
+}
+
+Series StreamingStockParser::takeSeries()
+{
+    Series series{symbol};
+    series.reserve(bars.size());
+
+    // The API lists the newest day first
+    const bool descending = bars.size() > 1 && bars.first().time > bars.last().time;
+    if (descending)
+    {
+        for (int i = bars.size() - 1; i >= 0; --i)
+            series.append(bars[i]);
+    }
+    else
+    {
+        for (const Bar& entry : bars)
+            series.append(entry);
+    }
+
+    series.sortByTime();
+    bars.clear();
+    return series;
+}
+
+void StreamingStockParser::onContainerStart(bool isObject)
+{
+    const int depth = static_cast<int>(stack.size());
+
+    if (depth == 1 && startsWith(stack[0].key, "Time Series"))
+    {
+        inTimeSeries = true;
+    }
+    else if (depth == 2 && inTimeSeries)
+    {
+        inBar = true;
+        barValid = true;
+        bar = Bar{};
+        bar.time = dateToTimestamp(stack[1].key);
+    }
+
+    stack.push_back(Level{ isObject, isObject, std::string() });
+}
+
+void StreamingStockParser::onContainerEnd()
+{
+    if (stack.empty())
+        return;
+
+    stack.pop_back();
+
+    if (inBar && stack.size() == 2)
+    {
+        if (barValid)
+            bars.append(bar);
+        inBar = false;
+    }
+    else if (inTimeSeries && stack.size() == 1)
+    {
+        inTimeSeries = false;
+    }
+}
+
+void StreamingStockParser::onToken(bool isString)
+{
+    if (!stack.empty() && stack.back().isObject && stack.back().expectKey && isString)
+    {
+        stack.back().key = token;
+        stack.back().expectKey = false;
+        return;
+    }
+
+    onValue(token);
+}
+
+void StreamingStockParser::onValue(const std::string& value)
+{
+    const size_t depth = stack.size();
+
+    if (inBar && depth == 3)
+    {
+        // Field names look like "1. open"; skip the ordinal
+        const std::string& key = stack[2].key;
+        const size_t dot = key.find(". ");
+        const std::string field = dot == std::string::npos ? key : key.substr(dot + 2);
+        double* target = nullptr;
+        if (field == "open")
+            target = &bar.open;
+        else if (field == "high")
+            target = &bar.high;
+        else if (field == "low")
+            target = &bar.low;
+        else if (field == "close")
+            target = &bar.close;
+        else if (field == "volume")
+            target = &bar.volume;
+        if (target == nullptr)
+            return;
+
+        // Not strtod: the C locale follows the user's, and a comma decimal would cut "189.97" to 189
+        bool ok = false;
+        *target = QByteArray::fromRawData(value.data(), static_cast<int>(value.size())).toDouble(&ok);
+        if (!ok)
+            barValid = false;
+    }
+    else if (depth == 2 && stack[0].key == "Meta Data" && stack[1].key == "2. Symbol")
+    {
+        symbol = QString::fromStdString(value);
+    }
+    else if (depth == 1 && (stack[0].key == "Note" || stack[0].key == "Error Message" || stack[0].key == "Information"))
+    {
+        error = QString::fromStdString(value);
+    }
+}
+
+}
@@ -0,0 +1,84 @@
+#ifndef STREAMINGSTOCKPARSER_HPP
+#define STREAMINGSTOCKPARSER_HPP
+
+#include <string>
+#include <vector>
+
+#include <QString>
+#include <QVector>
+
+#include "Series.hpp"
+
+namespace sv
+{
+
+/**
+ * @brief Resumable parser for the daily time-series JSON response.
+ *
+ * Bytes can be fed in arbitrary chunks as they arrive from the network; the
+ * tokenizer keeps its state across chunk boundaries, so parsing overlaps the
+ * download and nothing is buffered beyond the token in progress. Bars are
+ * collected as each date object closes.
+ */
+class StreamingStockParser
+{
+public:
+    void feed(const char* data, int size);
+
+    /**
+     * @brief Signal the end of input. Returns false if the document was
+     *        truncated or the API returned an error message instead of data.
+     */
+    bool finish();
+
+    QString getSymbol() const
+    {
+        return symbol;
+    }
+
+    QString getError() const
+    {
+        return error;
+    }
+
+    int barCount() const
+    {
+        return bars.size();
+    }
+
+    // The parsed bars as a series sorted by time
+    Series takeSeries();
+
+private:
+    enum class State { Value, String, Escape, Scalar };
+
+    void onContainerStart(bool isObject);
+    void onContainerEnd();
+    void onToken(bool isString);
+    void onValue(const std::string& value);
+
+    State state = State::Value;
+    std::string token;
+
+    // One entry per open container: object or array, whether a key is expected next, and its current key
+    struct Level
+    {
+        bool isObject;
+        bool expectKey;
+        std::string key;
+    };
+    std::vector<Level> stack;
+
+    bool inTimeSeries = false;
+    bool inBar = false;
+    bool barValid = false;           // false once a field fails to parse
+    Bar bar;
+
+    QString symbol;
+    QString error;
+    QVector<Bar> bars;
+};
+
+}
+
+#endif // STREAMINGSTOCKPARSER_HPP
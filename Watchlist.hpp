@@ -0,0 +1,58 @@
+#ifndef WATCHLIST_HPP
+#define WATCHLIST_HPP
+
+#include <QSettings>
+#include <QString>
+#include <QStringList>
+
+// The persistent list of symbols StockView keeps refreshed in the background
+class Watchlist
+{
+public:
+    Watchlist()
+        : settings(QStringLiteral("StockView"), QStringLiteral("StockView"))
+    {
+        symbols = settings.value(QStringLiteral("watchlist/symbols")).toStringList();
+    }
+
+    QStringList getSymbols() const
+    {
+        return symbols;
+    }
+
+    bool contains(const QString& symbol) const
+    {
+        return symbols.contains(symbol.toUpper());
+    }
+
+    bool add(const QString& symbol)
+    {
+        const QString normalized = symbol.trimmed().toUpper();
+        if (normalized.isEmpty() || symbols.contains(normalized))
+            return false;
+
+        symbols << normalized;
+        save();
+        return true;
+    }
+
+    bool remove(const QString& symbol)
+    {
+        if (!symbols.removeOne(symbol.toUpper()))
+            return false;
+
+        save();
+        return true;
+    }
+
+private:
+    void save()
+    {
+        settings.setValue(QStringLiteral("watchlist/symbols"), symbols);
+    }
+
+    QSettings settings;
+    QStringList symbols;
+};
+
+#endif // WATCHLIST_HPP
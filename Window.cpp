@@ -1,9 +1,19 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include <QDir>
 #include <QDirIterator>
 #include <QFile>
 #include <QFileDialog>
 #include <QGraphicsScene>
+#include <QInputDialog>
+#include <QSettings>
+#include <QStandardPaths>
 #include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QTimer>
 #include "PythonLauncher.hpp"
 #include "Window.hpp"
 
@@ -12,30 +22,227 @@
 
 using namespace sv;
 
+namespace
+{
+
+const QString pythonEnvironmentPath = "C:/Users/mattp/Documents/StockView/StockAnalyzerEnvironment/";
+const QStringList pythonModules = { "numpy", "pandas", "scipy" };
+
+// Bars of history before the first new bar handed to an analysis when extending a cached result
+const int extensionLookback = 250;
+
+// History decoded ahead of a replay's start date to warm the indicators and the forecast
+const double replayWarmupSeconds = 2 * 365 * 86400.0;
+
+// Backtest settings shared by single runs and sweeps
+sv::BacktestConfig backtestConfig(const QMap<QString, QString>& options)
+{
+    sv::BacktestConfig config;
+    config.initialCash = options.value("cash", "10000").toDouble();
+    config.commissionPerTrade = options.value("commission", "0").toDouble();
+    config.commissionRate = options.value("rate", "0").toDouble();
+    config.slippageBps = options.value("slippage", "0").toDouble();
+    config.allowShort = options.contains("short");
+    return config;
+}
+
+bool isBacktestOption(const QString& key)
+{
+    static const QStringList keys = { "strategy", "cash", "commission", "rate", "slippage", "short", "samples", "seed" };
+    return keys.contains(key);
+}
+
+// Accepts "20", "5,10,20" or an inclusive range "5:50:5"
+QVector<double> parameterValues(const QString& text)
+{
+    QVector<double> values;
+    const QStringList range = text.split(':');
+    if (range.size() == 3)
+    {
+        const double first = range[0].toDouble();
+        const double last = range[1].toDouble();
+        const double step = range[2].toDouble();
+        for (double value = first; step > 0 && value <= last + step * 1e-9; value += step)
+            values.append(value);
+        return values;
+    }
+
+    for (const QString& value : text.split(',', Qt::SkipEmptyParts))
+        values.append(value.toDouble());
+    return values;
+}
+
+QString describeParameters(const sv::ParameterSet& parameters)
+{
+    QStringList parts;
+    for (auto it = parameters.cbegin(); it != parameters.cend(); ++it)
+        parts << QString("%1=%2").arg(it.key()).arg(it.value());
+    return parts.join(' ');
+}
+
+}
+
 Window::Window(QWidget* parent) : QMainWindow(parent), ui(new Ui::Window)
 {
     ui->setupUi(this);
 
+    QElapsedTimer startup;
+    startup.start();
+
     scene = new QGraphicsScene(this);
     ui->TickerSymbols_LineEdit->setText("VUG");
     ui->FileSelect_LineEdit->setText("C:/Users/mattp/Documents/Qt/Projects/StockView/python/SimpleAnalysis.py");
     ui->InputArguments_LineEdit->setText("");
 //    deleteTempFiles();
 
+    connect(&dataFetcher, &DataFetcher::querySent, this, &Window::OnQuerySent);
+    connect(&dataFetcher, &DataFetcher::queryFailed, this, [this](const QString& symbol, const QString& error)
+    {
+        refreshScheduler.refreshFinished(symbol, false);
+        statusBar()->showMessage(symbol + ": " + error, 5000);
+    });
+    connect(&pipeline, &sv::SeriesPipeline::seriesReady, this, &Window::OnSeriesReady);
+    connect(&pipeline, &sv::SeriesPipeline::failed, this, &Window::OnSeriesFailed);
+    pipeline.setStore(&store);
+    seriesManager.setStore(&store);
+
+    // Watchlist symbols refresh in the background within the API rate limit
+    const QMap<QString, QString> env = sv::loadEnvFile();
+    refreshScheduler.setRequestsPerMinute(env.value("RATE_LIMIT_PER_MINUTE", "5").toInt());
+    seriesManager.setBudget(env.value("SERIES_MEMORY_MB", "256").toLongLong() << 20);
+    for (const QString& symbol : watchlist.getSymbols())
+    {
+        ui->Watchlist_ListWidget->addItem(symbol);
+        if (store.contains(symbol))
+            refreshScheduler.setLastRefreshed(symbol, QFileInfo(store.pathFor(symbol)).lastModified());
+    }
+    refreshScheduler.setSymbols(watchlist.getSymbols());
+    connect(&refreshScheduler, &RefreshScheduler::refreshRequested, this, &Window::fetchStockData);
+
+    // Intraday refreshes of current symbols share bulk quote requests when the API offers them
+    refreshScheduler.setQuoteBatchSize(dataFetcher.supportsBulkQuotes() ? dataFetcher.getMaxBatchSize() : 0);
+    connect(&refreshScheduler, &RefreshScheduler::quoteRequested, &dataFetcher, &DataFetcher::requestQuote);
+    connect(&dataFetcher, &DataFetcher::quoteReceived, this, &Window::OnQuoteReceived);
+
+    setAlertRules(QSettings("StockView", "StockView").value("alerts/rules").toStringList());
+
+    connect(&replayEngine, &ReplayEngine::rewound, this, &Window::onReplayRewound);
+    connect(&replayEngine, &ReplayEngine::barsReplayed, this, &Window::onReplayBars);
+    connect(&replayEngine, &ReplayEngine::finished, this, [this]()
+    {
+        const ReplayStatistics& statistics = replayEngine.getStatistics();
+        const QString summary = QString("Replay finished: %1 bars in %2 s (%3 bars/s, %4 us per bar in the update path, %5 late ticks)")
+            .arg(statistics.bars).arg(statistics.wallSeconds, 0, 'f', 2).arg(statistics.barsPerSecond(), 0, 'f', 0)
+            .arg(statistics.bars > 0 ? statistics.deliverySeconds * 1e6 / statistics.bars : 0.0, 0, 'f', 1)
+            .arg(statistics.lateTicks);
+        ui->ConsoleOutput_TextBrowser->append(summary);
+        statusBar()->showMessage(summary);
+    });
+
+    ui->actionExtendCachedResults->setChecked(QSettings("StockView", "StockView").value("analysis/extendCached").toBool());
+    connect(ui->actionExtendCachedResults, &QAction::toggled, this, [](bool checked)
+    {
+        QSettings("StockView", "StockView").setValue("analysis/extendCached", checked);
+    });
+
+    ui->actionForecastBand->setChecked(QSettings("StockView", "StockView").value("forecast/show").toBool());
+    connect(ui->actionForecastBand, &QAction::toggled, this, [this](bool checked)
+    {
+        QSettings("StockView", "StockView").setValue("forecast/show", checked);
+        showForecast();
+        if (checked)
+            reportForecast();
+    });
+
+    ui->EmbeddedPython_CheckBox->setEnabled(PythonLauncher::isEmbeddedAvailable());
+
+    // Paint the last session from the local store first; everything that can
+    // touch the network, load plugins or spawn Python waits for the event loop
+    restoreSession();
+    statusBar()->showMessage(QString("Session restored in %1 ms").arg(startup.elapsed()), 5000);
+    QTimer::singleShot(0, this, &Window::startBackgroundTasks);
+}
+
+void Window::closeEvent(QCloseEvent* event)
+{
+    saveSession();
+    QMainWindow::closeEvent(event);
+}
+
+void Window::startBackgroundTasks()
+{
     dataFetcher.setNetworkManager( new QNetworkAccessManager{this} );
     connect(dataFetcher.getNetworkManager(), &QNetworkAccessManager::finished,
             this, &Window::OnDataReceived);
 
+    refreshScheduler.start();
+    if (!displayedSymbol.isEmpty())
+        refreshScheduler.requestNow(displayedSymbol);
+
+    refreshAnalysisList();
+
+    // venv creation and pip can take minutes; have them done before the first Run
+    if (!ui->EmbeddedPython_CheckBox->isChecked())
+    {
+        taskPool.start([this]()
+        {
+            PythonLauncher::provisionEnvironment(pythonEnvironmentPath, pythonModules, &closing);
+        });
+    }
+}
+
+void Window::restoreSession()
+{
+    const sv::SessionState session = sv::SessionState::load();
+
+    if (!session.tickerSymbols.isEmpty())
+        ui->TickerSymbols_LineEdit->setText(session.tickerSymbols);
+    if (!session.scriptPath.isEmpty())
+        ui->FileSelect_LineEdit->setText(session.scriptPath);
+    ui->InputArguments_LineEdit->setText(session.arguments);
+
+    displayedSymbol = session.displayedSymbol;
+    if (displayedSymbol.isEmpty() || !showSymbol(displayedSymbol))
+        return;
+
+    refreshScheduler.setVisible(displayedSymbol);
+    ui->StockView_Chart->setXRange(session.viewFrom, session.viewTo);
+
+    if (!session.analysis.series.isEmpty() || !session.analysis.annotations.isEmpty())
+    {
+        lastAnalysis = session.analysis;
+        if (!lastAnalysis.series.isEmpty())
+            ui->StockView_Chart->setAllData(lastAnalysis.series.first());
+        ui->StockView_Chart->setOverlays(lastAnalysis.series.mid(1));
+        ui->StockView_Chart->setAnnotations(lastAnalysis.annotations);
+    }
+    if (!session.analysis.output.isEmpty())
+        ui->ConsoleOutput_TextBrowser->append(session.analysis.output);
+}
+
+void Window::saveSession() const
+{
+    sv::SessionState session;
+    session.tickerSymbols = ui->TickerSymbols_LineEdit->text();
+    session.displayedSymbol = displayedSymbol;
+    session.viewFrom = ui->StockView_Chart->getXFrom();
+    session.viewTo = ui->StockView_Chart->getXTo();
+    session.scriptPath = ui->FileSelect_LineEdit->text();
+    session.arguments = ui->InputArguments_LineEdit->text();
+    session.analysis = lastAnalysis;
+    session.save();
 }
 
 Window::~Window()
 {
+    closing = true;
+    taskPool.waitForDone();
     delete ui;
 }
 
 void Window::on_FileSelector_Button_clicked()
 {
-    QString filePath = QFileDialog::getOpenFileName(this, "Open File", "C:/Users/mattp/Documents/Qt/Projects/StockView/python", "Python File (*.py)");
+    QString filePath = QFileDialog::getOpenFileName(this, "Open File", "C:/Users/mattp/Documents/Qt/Projects/StockView/python", "Python File (*.py);;Plugin (*.dll *.so *.dylib)");
 
     if (!filePath.isEmpty())
         ui->FileSelect_LineEdit->setText(filePath);
@@ -43,56 +250,917 @@ void Window::on_FileSelector_Button_clicked()
 
 void Window::on_Run_Button_clicked()
 {
-    QString scriptPath = ui->FileSelect_LineEdit->text();
+    const QString scriptPath = ui->FileSelect_LineEdit->text();
+    const QStringList tickerSymbols = ui->TickerSymbols_LineEdit->text().split(';', Qt::SkipEmptyParts);
+    const QStringList extraArguments = ui->InputArguments_LineEdit->text().split(' ', Qt::SkipEmptyParts);
+
+    // The data file path changes between runs, so the job is keyed on the script and the user's arguments
+    const QByteArray scriptDigest = sv::AnalysisCache::fileDigest(scriptPath);
+    if (scriptDigest.isEmpty())
+    {
+        if (canRunNow(scriptPath))
+            showAnalysisResult(runAnalysis(scriptPath, currentSeries, tickerSymbols, extraArguments));
+        return;
+    }
+
+    const QByteArray job = sv::AnalysisCache::jobKey(scriptDigest, tickerSymbols + QStringList{"--"} + extraArguments);
+    const sv::AnalysisCache::Lookup cached = analysisCache.find(job, currentSeries);
+
+    if (cached.match == sv::AnalysisCache::Match::Exact)
+    {
+        ui->ConsoleOutput_TextBrowser->append("Cached result (script, arguments and data unchanged)\n");
+        showAnalysisResult(cached.result);
+        return;
+    }
+
+    if (!canRunNow(scriptPath))
+        return;
+
+    sv::AnalysisResult result;
+    if (cached.match == sv::AnalysisCache::Match::Appended && ui->actionExtendCachedResults->isChecked())
+    {
+        // Run on the new bars plus enough history for the analysis to warm up
+        const int start = std::max(0, cached.cachedRows - extensionLookback);
+        const sv::SeriesPtr tail = sv::SeriesPtr::create(currentSeries->mid(start));
+        ui->ConsoleOutput_TextBrowser->append(QString("Extending cached result with %1 new bars\n")
+                                              .arg(currentSeries->size() - cached.cachedRows));
+
+        result = runAnalysis(scriptPath, tail, tickerSymbols, extraArguments);
+        if (result.exitCode == 0)
+        {
+            const double cachedUntil = currentSeries->at(sv::Series::Time, cached.cachedRows - 1);
+            result = sv::AnalysisCache::extend(cached.result, result, cachedUntil);
+        }
+    }
+    else
+    {
+        result = runAnalysis(scriptPath, currentSeries, tickerSymbols, extraArguments);
+    }
+
+    if (result.exitCode == 0)
+        analysisCache.insert(job, currentSeries, result);
+    showAnalysisResult(result);
+}
+
+bool Window::canRunNow(const QString& scriptPath)
+{
+    // Plugins and the embedded interpreter do not use the venv
+    if (PluginHost::isPlugin(scriptPath) || ui->EmbeddedPython_CheckBox->isChecked()
+        || !PythonLauncher::isProvisioning())
+        return true;
+
+    statusBar()->showMessage("Python environment still provisioning; run again once pip has finished", 5000);
+    return false;
+}
 
+sv::AnalysisResult Window::runAnalysis(const QString& scriptPath, const sv::SeriesPtr& series,
+                                       const QStringList& tickerSymbols, const QStringList& extraArguments)
+{
     QStringList arguments;
 
-    QStringList tickerSymbols = ui->TickerSymbols_LineEdit->text().split(';', Qt::SkipEmptyParts);
-    QStringList extraArguments = ui->InputArguments_LineEdit->text().split(' ', Qt::SkipEmptyParts);
-    arguments << tempFilePath;
+    // Native plugins run in-process on the series already in memory
+    if (PluginHost::isPlugin(scriptPath))
+    {
+        arguments += tickerSymbols;
+        arguments += extraArguments;
+
+        ui->ConsoleOutput_TextBrowser->append("Plugin: " + pluginHost.pluginName(scriptPath) + "\n");
+        return pluginHost.run(scriptPath, series, arguments);
+    }
+
+    // Series shown from the cache have no data file until a script needs one; a
+    // partial series (when extending a cached result) gets a file of its own
+    const bool partial = !series.isNull() && series != currentSeries;
+    QString dataFile = tempFilePath;
+    if (partial)
+    {
+        dataFile = sv::writeStockDataFile(sv::StockDataResult{ series->toPoints(), {}, series });
+    }
+    else if (!series.isNull())
+    {
+        if (!dataFiles.contains(series->getSymbol()))
+        {
+            const sv::StockDataResult data{ series->toPoints(), {}, series };
+            dataFiles.insert(series->getSymbol(), sv::writeStockDataFile(data));
+        }
+        dataFile = tempFilePath = dataFiles.value(series->getSymbol());
+    }
+    ui->DataFile_LineEdit->setText( "Current Data File: " + dataFile );
+
+    arguments << dataFile;
     arguments += tickerSymbols;
     arguments += extraArguments;
 
-    QString wslCommand = "python " + sv::convertToWslPath(scriptPath) + " " + sv::convertToWslPath(tempFilePath);
+    QString wslCommand = "python " + sv::convertToWslPath(scriptPath) + " " + sv::convertToWslPath(dataFile);
     wslCommand += " " + tickerSymbols.join(' ');
     wslCommand += " " + extraArguments.join(' ');
     ui->ConsoleOutput_TextBrowser->append("WSL command: \n" + wslCommand + "\n\n");
     ui->ConsoleOutput_TextBrowser->update();
 
     QSharedPointer<PythonLauncher> launcher = PythonLauncher::create(scriptPath, arguments);
+    launcher->setEmbedded(ui->EmbeddedPython_CheckBox->isChecked());
+    launcher->setInputSeries(series);
 
-    QString environmentPath = "C:/Users/mattp/Documents/StockView/StockAnalyzerEnvironment/";
+    launcher->addVirtualEnvironment(pythonEnvironmentPath, pythonModules);
 
-    launcher->addVirtualEnvironment(environmentPath, {"numpy", "pandas", "scipy"});
+    sv::AnalysisResult result;
+    result.exitCode = launcher->run();
+    result.output = launcher->getOutput();
 
-    int exitCode = launcher->run();
+    if (partial)
+        QFile::remove(dataFile);
 
-    QString outputString = launcher->getOutput();
-
-    ui->ConsoleOutput_TextBrowser->append(outputString);
-
-    const QStringList toks = outputString.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    const QStringList toks = result.output.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
     const bool hasEstimate = toks.contains("Estimate:") && toks.at( toks.indexOf("Estimate:")+1 ) == "Yes";
     if (hasEstimate)
     {
         const QString outPath = *std::find_if(toks.begin(), toks.end(),
                                               [](const QString& str){ return str.startsWith("C:"); });
 
-        sv::StockDataResult estimate = readStockData(outPath, tickerSymbols.at(0));
-        ui->StockView_Chart->setAllData(estimate);
+        result.series.append(sv::readStockData(outPath, tickerSymbols.at(0)));
+    }
+
+    return result;
+}
+
+void Window::on_Reload_Button_clicked()
+{
+    pluginHost.reloadAll();
+    refreshAnalysisList();
+    ui->ConsoleOutput_TextBrowser->append("Plugins reloaded.\n");
+}
+
+void Window::on_Analysis_ComboBox_activated(int index)
+{
+    const QString filePath = ui->Analysis_ComboBox->itemData(index).toString();
+
+    if (!filePath.isEmpty())
+        ui->FileSelect_LineEdit->setText(filePath);
+}
+
+void Window::on_actionBacktest_triggered()
+{
+    if (currentSeries.isNull() || currentSeries->isEmpty())
+    {
+        statusBar()->showMessage("Graph a ticker before running a backtest", 5000);
+        return;
+    }
+
+    const QMap<QString, QString> options =
+        sv::parseKeyValueArguments(ui->InputArguments_LineEdit->text().split(' ', Qt::SkipEmptyParts));
+    const QString strategyName = options.value("strategy", "sma");
+    const sv::StrategyFactory factory = sv::strategyFactory(strategyName);
+
+    if (!factory)
+    {
+        statusBar()->showMessage("Unknown strategy: " + strategyName, 5000);
+        return;
+    }
+
+    sv::ParameterSet parameters;
+    for (auto it = options.cbegin(); it != options.cend(); ++it)
+    {
+        if (!isBacktestOption(it.key()))
+            parameters.insert(it.key(), it.value().toDouble());
+    }
+
+    const sv::BacktestConfig config = backtestConfig(options);
+    std::unique_ptr<sv::Strategy> strategy = factory(parameters);
+    const sv::BacktestResult backtest = sv::Backtester(config).run(*currentSeries, *strategy);
+
+    sv::AnalysisResult result;
+    result.output = QString("Backtest of %1 on %2 (%3)\n").arg(strategyName, currentSeries->getSymbol(),
+                                                                  describeParameters(parameters));
+    result.metrics = {
+        {"Total Return (%)", backtest.metrics.totalReturn * 100},
+        {"Max Drawdown (%)", backtest.metrics.maxDrawdown * 100},
+        {"Sharpe Ratio", backtest.metrics.sharpe},
+        {"Trades", double(backtest.metrics.tradeCount)}
+    };
+
+    // Scale the equity curve to the starting price so it shares the price axis
+    const double scale = currentSeries->at(sv::Series::Close, 0) / config.initialCash;
+    sv::StockDataResult equity;
+    for (int i = 0; i < backtest.time.size(); ++i)
+        equity.points.append(QPointF(backtest.time[i], backtest.equity[i] * scale));
+    equity.labels = {
+        {"x_axis", "Date"},
+        {"y_axis", "Price (USD)"},
+        {"legend", "Equity (" + strategyName + ", scaled to price)"},
+        {"title", currentSeries->getSymbol() + " Backtest"}
+    };
+    result.series.append(equity);
+
+    for (const sv::Trade& trade : backtest.trades)
+    {
+        result.annotations.append(sv::Annotation{ trade.time, QString("%1 %2 @ %3")
+            .arg(trade.quantity > 0 ? "Buy" : "Sell").arg(std::abs(trade.quantity)).arg(trade.price, 0, 'f', 2) });
+    }
+
+    showAnalysisResult(result);
+}
+
+void Window::on_actionParameterSweep_triggered()
+{
+    // Every watched and loaded ticker
+    QStringList symbols = watchlist.getSymbols() + seriesManager.symbols();
+    std::sort(symbols.begin(), symbols.end());
+    symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+    if (symbols.isEmpty())
+    {
+        statusBar()->showMessage("Graph or watch a ticker before running a sweep", 5000);
+        return;
+    }
+
+    const QMap<QString, QString> options =
+        sv::parseKeyValueArguments(ui->InputArguments_LineEdit->text().split(' ', Qt::SkipEmptyParts));
+    const QString strategyName = options.value("strategy", "sma");
+    const sv::StrategyFactory factory = sv::strategyFactory(strategyName);
+
+    if (!factory)
+    {
+        statusBar()->showMessage("Unknown strategy: " + strategyName, 5000);
+        return;
+    }
+
+    sv::ParameterGrid grid;
+    for (auto it = options.cbegin(); it != options.cend(); ++it)
+    {
+        if (!isBacktestOption(it.key()))
+            grid.axes.insert(it.key(), parameterValues(it.value()));
+    }
+
+    const int samples = options.value("samples", "0").toInt();
+    const QVector<sv::ParameterSet> parameters = samples > 0
+        ? grid.sample(samples, options.value("seed", "1").toUInt())
+        : grid.combinations();
+    const sv::BacktestConfig config = backtestConfig(options);
+
+    // Series already in memory are shared; the rest are decoded by the job
+    QVector<sv::SeriesPtr> inMemory;
+    for (const QString& symbol : symbols)
+        inMemory.append(seriesManager.peek(symbol));
+
+    statusBar()->showMessage(QString("Sweeping %1 parameter sets over %2 tickers...")
+                             .arg(parameters.size()).arg(symbols.size()));
+
+    taskPool.start([this, symbols, inMemory, parameters, factory, config]()
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QVector<sv::SeriesPtr> series;
+        for (int i = 0; i < symbols.size() && !closing; ++i)
+        {
+            const sv::SeriesPtr loaded = !inMemory[i].isNull() ? inMemory[i] : store.load(symbols[i]);
+            if (!loaded.isNull() && !loaded->isEmpty())
+                series.append(loaded);
+        }
+
+        QVector<sv::SweepResult> results = sv::runSweep(series, parameters, factory, config, 0, &closing);
+        const qint64 elapsed = timer.elapsed();
+        if (closing)
+            return;
+
+        std::sort(results.begin(), results.end(), [](const sv::SweepResult& a, const sv::SweepResult& b)
+                  { return a.metrics.sharpe > b.metrics.sharpe; });
+
+        QString report = QString("Parameter sweep: %1 backtests over %2 tickers in %3 ms\n")
+            .arg(results.size()).arg(series.size()).arg(elapsed);
+        for (int i = 0; i < std::min<int>(10, results.size()); ++i)
+        {
+            const sv::SweepResult& result = results[i];
+            report += QString("%1  %2  sharpe %3  return %4%  drawdown %5%  trades %6\n")
+                .arg(series[result.seriesIndex]->getSymbol(), describeParameters(parameters[result.parameterIndex]))
+                .arg(result.metrics.sharpe, 0, 'f', 2)
+                .arg(result.metrics.totalReturn * 100, 0, 'f', 1)
+                .arg(result.metrics.maxDrawdown * 100, 0, 'f', 1)
+                .arg(result.metrics.tradeCount);
+        }
+
+        QMetaObject::invokeMethod(this, [this, report]()
+        {
+            ui->ConsoleOutput_TextBrowser->append(report);
+            statusBar()->clearMessage();
+        }, Qt::QueuedConnection);
+    });
+}
+
+void Window::on_actionCorrelation_triggered()
+{
+    QStringList symbols = seriesManager.symbols();
+    if (symbols.size() < 2)
+    {
+        statusBar()->showMessage("Graph at least two tickers (separated by ';') first", 5000);
+        return;
+    }
+    std::sort(symbols.begin(), symbols.end());
+
+    const QMap<QString, QString> options =
+        sv::parseKeyValueArguments(ui->InputArguments_LineEdit->text().split(' ', Qt::SkipEmptyParts));
+    const int window = options.value("window", "0").toInt();
+
+    // Evicted series are decoded by a task rather than paged in here
+    QVector<sv::SeriesPtr> inMemory;
+    for (const QString& symbol : symbols)
+        inMemory.append(seriesManager.peek(symbol));
+
+    taskPool.start([this, symbols, inMemory, window]()
+    {
+        QVector<sv::SeriesPtr> series;
+        for (int i = 0; i < symbols.size() && !closing; ++i)
+        {
+            const sv::SeriesPtr loaded = !inMemory[i].isNull() ? inMemory[i] : store.load(symbols[i]);
+            if (!loaded.isNull())
+                series.append(loaded);
+        }
+        if (closing)
+            return;
+
+        QMetaObject::invokeMethod(this, [this, series, window]() { showCorrelation(series, window); },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void Window::showCorrelation(const QVector<sv::SeriesPtr>& series, int window)
+{
+    // Keep the engine between runs so only newly appended bars are applied
+    if (window != correlationWindow)
+    {
+        correlationEngine = sv::CorrelationEngine(window);
+        correlationWindow = window;
     }
 
-    if (exitCode != 0)
+    QElapsedTimer timer;
+    timer.start();
+    correlationEngine.update(series);
+    correlationEngine.correlation();     // cached for refreshHeatmap
+    const qint64 elapsed = timer.elapsed();
+
+    if (heatmap.isNull())
+    {
+        heatmap = new HeatmapWidget(this);
+        heatmap->setWindowFlag(Qt::Window);
+        heatmap->setAttribute(Qt::WA_DeleteOnClose);
+        heatmap->resize(600, 600);
+    }
+
+    refreshHeatmap();
+    heatmap->show();
+    heatmap->raise();
+
+    statusBar()->showMessage(QString("Correlation of %1 series computed in %2 ms")
+                             .arg(correlationEngine.symbols().size()).arg(elapsed), 5000);
+}
+
+void Window::refreshHeatmap()
+{
+    if (heatmap.isNull())
+        return;
+
+    heatmap->setMatrix(correlationEngine.symbols(), correlationEngine.correlation());
+    heatmap->setTitle(QString("Return correlation, %1 observations%2")
+                      .arg(correlationEngine.observations())
+                      .arg(correlationWindow > 0 ? QString(" (rolling %1)").arg(correlationWindow) : QString()));
+}
+
+void Window::on_actionDashboard_triggered()
+{
+    if (dashboard.isNull())
+    {
+        dashboard = new DashboardWidget(this);
+        dashboard->setWindowFlag(Qt::Window);
+        dashboard->setAttribute(Qt::WA_DeleteOnClose);
+        dashboard->resize(1200, 800);
+        connect(dashboard, &DashboardWidget::symbolActivated, this, &Window::on_Watchlist_ListWidget_currentTextChanged);
+    }
+
+    refreshDashboardSymbols();
+    dashboard->show();
+    dashboard->raise();
+}
+
+void Window::refreshDashboardSymbols()
+{
+    if (dashboard.isNull())
+        return;
+
+    const QStringList symbols = dashboardSymbols();
+    dashboard->setSymbols(symbols);
+    for (const QString& symbol : symbols)
+        dashboard->setSeries(symbol, seriesManager.get(symbol));
+    dashboard->setWindowTitle(QString("Dashboard (%1 symbols)").arg(symbols.size()));
+}
+
+void Window::on_actionMemoryUsage_triggered()
+{
+    const sv::SeriesMemoryUsage usage = seriesManager.usage();
+    const auto megabytes = [](qint64 bytes) { return QString::number(bytes / 1048576.0, 'f', 1); };
+
+    const QString report = QString("Series memory: %1 of %2 MB resident (%3 series, %4 MB pinned by quotes); "
+                                   "%5 evicted: %6 MB still shared, %7 MB in the store")
+        .arg(megabytes(usage.residentBytes)).arg(megabytes(seriesManager.getBudget()))
+        .arg(usage.residentCount).arg(megabytes(usage.pinnedBytes)).arg(usage.evictedCount)
+        .arg(megabytes(usage.sharedBytes)).arg(megabytes(usage.mappedBytes));
+    ui->ConsoleOutput_TextBrowser->append(report);
+    statusBar()->showMessage(report, 5000);
+}
+
+void Window::showForecast()
+{
+    // A replayed symbol shows the forecast as of the replayed bars
+    const bool replaying = replayEngine.isActive() && replayEngine.getSeries()->getSymbol() == displayedSymbol;
+    const auto live = forecasters.constFind(displayedSymbol);
+    const sv::ForecastBand band = replaying ? replayForecaster.band()
+        : live != forecasters.constEnd() ? live->band() : sv::ForecastBand();
+
+    if (!ui->actionForecastBand->isChecked() || band.isEmpty())
+        ui->StockView_Chart->setForecast({}, {}, {});
+    else
+        ui->StockView_Chart->setForecast(band.expected, band.lower, band.upper);
+}
+
+void Window::reportForecast()
+{
+    const bool replaying = replayEngine.isActive() && replayEngine.getSeries()->getSymbol() == displayedSymbol;
+    const auto live = forecasters.constFind(displayedSymbol);
+    if (!replaying && live == forecasters.constEnd())
+        return;
+
+    const sv::OuForecaster& forecaster = replaying ? replayForecaster : *live;
+    const sv::OuParameters parameters = forecaster.parameters();
+    if (forecaster.band().isEmpty())
+        return;
+
+    ui->ConsoleOutput_TextBrowser->append(
+        QString("Forecast %1: theta %2, mean level $%3, sigma %4, trend %5% per bar; band rebuilt %6 times over %7 bars")
+        .arg(displayedSymbol).arg(parameters.theta, 0, 'f', 4).arg(std::exp(parameters.mu), 0, 'f', 2)
+        .arg(parameters.sigma, 0, 'f', 4).arg(parameters.trend * 100, 0, 'f', 3)
+        .arg(forecaster.getRebuildCount()).arg(forecaster.barCount()));
+}
+
+void Window::on_actionImportDirectory_triggered()
+{
+    const QString directory = QFileDialog::getExistingDirectory(this, "Import Directory");
+    if (directory.isEmpty())
+        return;
+
+    statusBar()->showMessage("Importing " + directory + "...");
+
+    // Downloads for these symbols are stored after the import, merged with it
+    const QStringList symbols = sv::SeriesImporter::symbolsIn(directory);
+    pipeline.holdSymbols(symbols);
+
+    taskPool.start([this, directory, symbols]()
+    {
+        sv::SeriesImporter importer(&store);
+        importer.setCancelFlag(&closing);
+        importer.setProgress([this](int done, int total)
+        {
+            QMetaObject::invokeMethod(this, [this, done, total]()
+            {
+                statusBar()->showMessage(QString("Importing: %1 of %2 files").arg(done).arg(total));
+            }, Qt::QueuedConnection);
+        });
+        const sv::ImportReport report = importer.importDirectory(directory);
+
+        QMetaObject::invokeMethod(this, [this, report, symbols]()
+        {
+            pipeline.releaseSymbols(symbols);
+
+            // Loaded versions predate the import
+            for (const QString& symbol : report.symbols)
+            {
+                seriesManager.remove(symbol);
+                discardDataFile(symbol);
+                quoteIndicators.remove(symbol);
+            }
+            if (report.symbols.contains(displayedSymbol) && !replayEngine.isActive())
+                showSymbol(displayedSymbol);
+
+            QString text = QString("Import: %1 of %2 files, %3 rows (%4 rejected) in %5 s, %6 rows/s")
+                .arg(report.imported).arg(report.files).arg(report.rows).arg(report.rejectedRows)
+                .arg(report.seconds, 0, 'f', 2).arg(report.rowsPerSecond(), 0, 'f', 0);
+            for (const QString& error : report.errors.mid(0, 20))
+                text += "\n" + error;
+            if (report.errors.size() > 20)
+                text += QString("\n... and %1 more").arg(report.errors.size() - 20);
+            ui->ConsoleOutput_TextBrowser->append(text);
+            statusBar()->showMessage(QString("Imported %1 symbols").arg(report.imported), 5000);
+        }, Qt::QueuedConnection);
+    });
+}
+
+QStringList Window::dashboardSymbols() const
+{
+    QStringList symbols = watchlist.getSymbols();
+    if (symbols.isEmpty())
+    {
+        for (const QString& stock : ui->TickerSymbols_LineEdit->text().split(';', Qt::SkipEmptyParts))
+            symbols.append(stock.trimmed().toUpper());
+    }
+    return symbols;
+}
+
+void Window::on_actionAlertRules_triggered()
+{
+    bool accepted = false;
+    const QString text = QInputDialog::getMultiLineText(this, "Alert Rules",
+        "One rule per line, optionally prefixed by a symbol, e.g.\n"
+        "AAPL: close crosses above sma(50)\n"
+        "rsi(14) > 70\n"
+        "change(5) <= -8 and volume > 1000000",
+        alertRules.join('\n'), &accepted);
+
+    if (!accepted)
+        return;
+
+    setAlertRules(text.split('\n', Qt::SkipEmptyParts));
+    QSettings("StockView", "StockView").setValue("alerts/rules", alertRules);
+
+    // Warm the new rules on the series in memory; the others warm on their
+    // next update, since a symbol's first update only warms. Paging them all
+    // in here would churn the whole store through the memory budget.
+    for (const QString& symbol : seriesManager.symbols())
+    {
+        const sv::SeriesPtr series = seriesManager.peek(symbol);
+        if (!series.isNull())
+            alertEngine.update(*series);
+    }
+}
+
+void Window::setAlertRules(const QStringList& rules)
+{
+    alertEngine.clear();
+    alertRules.clear();
+
+    for (const QString& line : rules)
+    {
+        const QString rule = line.trimmed();
+        if (rule.isEmpty() || rule.startsWith('#'))
+            continue;
+
+        const int colon = rule.indexOf(':');
+        const QString symbol = colon > 0 ? rule.left(colon) : QString();
+        const QString expression = colon > 0 ? rule.mid(colon + 1) : rule;
+
+        QString error;
+        if (alertEngine.addRule(symbol, expression, &error) < 0)
+            ui->ConsoleOutput_TextBrowser->append(QString("Alert rule \"%1\": %2").arg(rule, error));
+
+        alertRules << rule;
+    }
+}
+
+void Window::on_actionReplayStart_triggered()
+{
+    // Replays come from the local store, never the network
+    if (displayedSymbol.isEmpty() || !store.contains(displayedSymbol))
+    {
+        statusBar()->showMessage("Graph a ticker with stored history before starting a replay", 5000);
+        return;
+    }
+
+    bool ok = false;
+    const QString text = QInputDialog::getText(this, "Replay " + displayedSymbol,
+        "Bars per second (1 to 10000, 0 for as fast as possible) and an optional start date:",
+        QLineEdit::Normal, QString("speed=%1").arg(replayEngine.getSpeed()), &ok);
+    if (!ok)
+        return;
+
+    const QMap<QString, QString> options = sv::parseKeyValueArguments(text.split(' ', Qt::SkipEmptyParts));
+    const QDate from = QDate::fromString(options.value("from"), "yyyy-MM-dd");
+    const double start = from.isValid() ? QDateTime(from, QTime(0, 0)).toSecsSinceEpoch() : 0;
+
+    // With a start date only the blocks from the warm-up period on are decoded;
+    // seeking back before them needs a new replay
+    const sv::SeriesPtr history = from.isValid()
+        ? store.load(displayedSymbol, start - replayWarmupSeconds, std::numeric_limits<double>::infinity())
+        : store.load(displayedSymbol);
+    if (history.isNull() || history->size() < 2)
+    {
+        statusBar()->showMessage("Not enough stored history to replay " + displayedSymbol, 5000);
+        return;
+    }
+
+    replayEngine.setSpeed(options.value("speed", "100").toDouble());
+    replayEngine.setSeries(history);
+    if (from.isValid())
+        replayEngine.seek(replayEngine.positionFor(start));
+
+    replayEngine.play();
+}
+
+void Window::on_actionReplayPause_triggered()
+{
+    if (replayEngine.isPlaying())
+        replayEngine.pause();
+    else
+        replayEngine.play();
+}
+
+void Window::on_actionReplayStep_triggered()
+{
+    replayEngine.pause();
+    replayEngine.step();
+}
+
+void Window::on_actionReplaySeek_triggered()
+{
+    if (!replayEngine.isActive())
+        return;
+
+    const sv::SeriesPtr history = replayEngine.getSeries();
+    const int position = std::min(replayEngine.getPosition(), history->size() - 1);
+    bool ok = false;
+    const QString text = QInputDialog::getText(this, "Seek Replay", "Date (yyyy-MM-dd):", QLineEdit::Normal,
+        QDateTime::fromSecsSinceEpoch(static_cast<qint64>(history->at(sv::Series::Time, position))).toString("yyyy-MM-dd"), &ok);
+
+    const QDate date = QDate::fromString(text.trimmed(), "yyyy-MM-dd");
+    if (ok && date.isValid())
+        replayEngine.seek(replayEngine.positionFor(QDateTime(date, QTime(0, 0)).toSecsSinceEpoch()));
+}
+
+void Window::on_actionReplayStop_triggered()
+{
+    if (!replayEngine.isActive())
+        return;
+
+    const QString symbol = replayEngine.getSeries()->getSymbol();
+    replayEngine.setSeries(sv::SeriesPtr());
+
+    // Back to the live series; its next update warms the alert state again
+    alertEngine.resetSymbol(symbol);
+    if (symbol == displayedSymbol)
+        showSymbol(symbol);
+}
+
+void Window::onReplayRewound(const sv::SeriesPtr& history, int position)
+{
+    const sv::Series delivered = history->mid(0, position);
+    const QString symbol = history->getSymbol();
+
+    alertEngine.resetSymbol(symbol);
+    alertEngine.update(delivered);
+
+    replayIndicators.reset();
+    const double* close = delivered.column(sv::Series::Close);
+    for (int i = 0; i < delivered.size(); ++i)
+        replayIndicators.push(close[i]);
+
+    replayForecaster.reset();
+    replayForecaster.update(delivered);
+
+    if (symbol == displayedSymbol)
+    {
+        ui->StockView_Chart->resetZoom();
+        ui->StockView_Chart->setOverlays({});
+        ui->StockView_Chart->setAnnotations({});
+        ui->StockView_Chart->setData(delivered.toPoints(), sv::priceLabels(symbol));
+        showForecast();
+    }
+}
+
+void Window::onReplayBars(const QString& symbol, const QVector<sv::Bar>& bars)
+{
+    QVector<sv::AlertHit> hits;
+    QVector<QPointF> points;
+    points.reserve(bars.size());
+    bool forecastRebuilt = false;
+    for (const sv::Bar& bar : bars)
+    {
+        hits += alertEngine.append(symbol, bar);
+        replayIndicators.push(bar.close);
+        forecastRebuilt |= replayForecaster.append(bar.time, bar.close);
+        points.append(QPointF(bar.time, bar.close));
+    }
+    reportAlerts(hits, true);
+
+    if (symbol != displayedSymbol)
+        return;
+
+    ui->StockView_Chart->appendPoints(points);
+    if (forecastRebuilt)
+        showForecast();
+
+    const QMap<QString, double> indicators = replayIndicators.values();
+    QStringList snapshot;
+    for (auto it = indicators.cbegin(); it != indicators.cend(); ++it)
+        snapshot << QString("%1 %2").arg(it.key()).arg(it.value(), 0, 'f', 2);
+
+    if (hits.isEmpty())
+    {
+        statusBar()->showMessage(QString("Replay %1 %2: %3  (%4 bars/s)").arg(symbol,
+            QDateTime::fromSecsSinceEpoch(static_cast<qint64>(bars.last().time)).toString("yyyy-MM-dd"),
+            snapshot.join("  ")).arg(replayEngine.getStatistics().barsPerSecond(), 0, 'f', 0));
+    }
+}
+
+void Window::reportAlerts(const QVector<sv::AlertHit>& hits, bool replayed)
+{
+    if (hits.isEmpty())
+        return;
+
+    const QString logPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(logPath);
+    QFile log(logPath + "/alerts.log");
+    const bool logOpen = !replayed && log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+    QTextStream stream(&log);
+
+    for (const sv::AlertHit& hit : hits)
+    {
+        const QString message = QString("%1 %2: %3").arg(hit.symbol,
+            QDateTime::fromSecsSinceEpoch(static_cast<qint64>(hit.time)).toString("yyyy-MM-dd"), hit.expression);
+
+        ui->ConsoleOutput_TextBrowser->append((replayed ? "Replay alert: " : "Alert: ") + message);
+        if (logOpen)
+            stream << QDateTime::currentDateTime().toString(Qt::ISODate) << " " << message << "\n";
+    }
+
+    statusBar()->showMessage(QString("%1: %2 %3%4").arg(replayed ? "Replay alert" : "Alert")
+                             .arg(hits.last().symbol, hits.last().expression,
+                                  hits.size() > 1 ? QString(" (+%1 more)").arg(hits.size() - 1) : QString()), 10000);
+}
+
+void Window::refreshAnalysisList()
+{
+    const QString projectRoot = sv::findProjectRoot();
+    const QStringList directories = {
+        projectRoot + "/python",
+        projectRoot + "/plugins",
+        QCoreApplication::applicationDirPath() + "/plugins"
+    };
+
+    ui->Analysis_ComboBox->clear();
+    for (const QString& filePath : PluginHost::discover(directories))
+    {
+        const QString label = PluginHost::isPlugin(filePath)
+            ? "[native] " + pluginHost.pluginName(filePath)
+            : "[python] " + QFileInfo(filePath).fileName();
+        ui->Analysis_ComboBox->addItem(label, filePath);
+    }
+}
+
+void Window::showAnalysisResult(const sv::AnalysisResult& result)
+{
+    lastAnalysis = result;
+    ui->ConsoleOutput_TextBrowser->append(result.output);
+
+    for (auto it = result.metrics.cbegin(); it != result.metrics.cend(); ++it)
+        ui->ConsoleOutput_TextBrowser->append(QString("%1: %2").arg(it.key()).arg(it.value(), 0, 'f', 4));
+
+    // The first series goes through the estimate path, anything else is drawn as an overlay
+    if (!result.series.isEmpty())
+        ui->StockView_Chart->setAllData(result.series.first());
+    ui->StockView_Chart->setOverlays(result.series.mid(1));
+    ui->StockView_Chart->setAnnotations(result.annotations);
+
+    if (result.exitCode != 0)
     {
         QMessageBox::warning(this, "Script Error",
-                             QString("Python script exited with code %1.").arg(exitCode));
+                             QString("Analysis exited with code %1.").arg(result.exitCode));
     }
 }
 
 void Window::on_GraphStocks_Button_clicked()
 {
-    const auto stock = ui->TickerSymbols_LineEdit->text();
-    fetchStockData(stock);
+    const QStringList stocks = ui->TickerSymbols_LineEdit->text().split(';', Qt::SkipEmptyParts);
+    if (stocks.isEmpty())
+        return;
+
+    displayedSymbol = stocks.first().trimmed().toUpper();
+    showSymbol(displayedSymbol);
+    refreshScheduler.setVisible(displayedSymbol);
+
+    for (const QString& stock : stocks)
+    {
+        const QString symbol = stock.trimmed().toUpper();
+        seriesManager.get(symbol);
+        refreshScheduler.requestNow(symbol);
+    }
+}
+
+void Window::on_AddToWatchlist_Button_clicked()
+{
+    const QStringList stocks = ui->TickerSymbols_LineEdit->text().split(';', Qt::SkipEmptyParts);
+    for (const QString& stock : stocks)
+    {
+        if (watchlist.add(stock))
+            ui->Watchlist_ListWidget->addItem(stock.trimmed().toUpper());
+    }
+    refreshScheduler.setSymbols(watchlist.getSymbols());
+    refreshDashboardSymbols();
+}
+
+void Window::on_RemoveFromWatchlist_Button_clicked()
+{
+    QListWidgetItem* item = ui->Watchlist_ListWidget->currentItem();
+    if (item == nullptr)
+        return;
+
+    watchlist.remove(item->text());
+    delete item;
+    refreshScheduler.setSymbols(watchlist.getSymbols());
+    refreshDashboardSymbols();
+}
+
+void Window::on_Watchlist_ListWidget_currentTextChanged(const QString& symbol)
+{
+    if (symbol.isEmpty())
+        return;
+
+    displayedSymbol = symbol;
+    ui->TickerSymbols_LineEdit->setText(symbol);
+    refreshScheduler.setVisible(symbol);
+    refreshScheduler.markViewed(symbol);
+
+    if (!showSymbol(symbol))
+        refreshScheduler.requestNow(symbol);
+}
+
+void Window::fetchStockData(const QString& symbol)
+{
+    // Daily bars: if the cache reaches back within the compact window (100
+    // trading days), only the tail needs downloading and is merged on arrival
+    const sv::SeriesPtr cached = seriesManager.get(symbol);
+
+    const double compactSpan = 140 * 24 * 3600.0;
+    const bool tailOnly = !cached.isNull() && !cached->isEmpty()
+        && QDateTime::currentSecsSinceEpoch() - cached->lastTime() < compactSpan;
+
+    dataFetcher.MakeQuery(symbol, tailOnly);
+}
+
+void Window::publishSeries(const sv::SeriesPtr& series, const QMap<QString, double>& indicators)
+{
+    const QString symbol = series->getSymbol();
+
+    // A symbol being replayed keeps its replayed chart and alert state until the replay stops
+    const bool replaying = replayEngine.isActive() && replayEngine.getSeries()->getSymbol() == symbol;
+    if (!replaying)
+        reportAlerts(alertEngine.update(*series));
+    forecasters[symbol].update(*series);
+
+    // Quotes arrive in batches; the matrix is updated once per batch
+    if (!replaying && correlationEngine.stage(*series) && !correlationCommitPending)
+    {
+        correlationCommitPending = true;
+        QTimer::singleShot(0, this, [this]()
+        {
+            correlationCommitPending = false;
+            if (correlationEngine.commit())
+                refreshHeatmap();
+        });
+    }
+    if (!dashboard.isNull())
+        dashboard->setSeries(symbol, series);
+
+    // Background refreshes only update the cache unless the symbol is on screen
+    if (symbol != displayedSymbol || replaying)
+        return;
+
+    displaySeries(series);
+
+    QStringList snapshot;
+    for (auto it = indicators.cbegin(); it != indicators.cend(); ++it)
+        snapshot << QString("%1 %2").arg(it.key()).arg(it.value(), 0, 'f', 2);
+    statusBar()->showMessage(symbol + ": " + snapshot.join("  "));
+}
+
+bool Window::showSymbol(const QString& symbol)
+{
+    const sv::SeriesPtr series = seriesManager.get(symbol);
+    if (series.isNull())
+        return false;
+
+    displaySeries(series);
+    return true;
+}
+
+void Window::displaySeries(const sv::SeriesPtr& series)
+{
+    // A zoom range only means something for the series it was set on
+    if (currentSeries.isNull() || currentSeries->getSymbol() != series->getSymbol())
+        ui->StockView_Chart->resetZoom();
+
+    currentSeries = series;
+    ui->StockView_Chart->setData(series->toPoints(), sv::priceLabels(series->getSymbol()));
+    forecasters[series->getSymbol()].update(*series);
+    showForecast();
+
+    tempFilePath = dataFiles.value(series->getSymbol());
+    ui->DataFile_LineEdit->setText( "Current Data File: " + tempFilePath );
+}
+
+void Window::discardDataFile(const QString& symbol)
+{
+    const QString path = dataFiles.take(symbol);
+    if (path.isEmpty())
+        return;
+
+    QFile::remove(path);
+    if (tempFilePath == path)
+        tempFilePath.clear();
 }
 
 void Window::deleteTempFiles() const
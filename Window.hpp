@@ -21,10 +21,31 @@
 #include <QDebug>
 #include <QTemporaryFile>
 #include <QProcessEnvironment>
-
+#include <QPointer>
+#include <QThreadPool>
+
+#include "AlertEngine.hpp"
+#include "AnalysisCache.hpp"
+#include "Backtester.hpp"
+#include "CorrelationEngine.hpp"
+#include "DashboardWidget.hpp"
 #include "DataFetcher.hpp"
+#include "HeatmapWidget.hpp"
+#include "Indicators.hpp"
+#include "OuForecaster.hpp"
+#include "PluginHost.hpp"
 #include "QtUtils.hpp"
 #include "QueryBuilder.hpp"
+#include "RefreshScheduler.hpp"
+#include "ReplayEngine.hpp"
+#include "Series.hpp"
+#include "SeriesImporter.hpp"
+#include "SeriesManager.hpp"
+#include "SeriesPipeline.hpp"
+#include "SeriesStore.hpp"
+#include "SessionState.hpp"
+#include "StockParser.hpp"
+#include "Watchlist.hpp"
 
 QT_BEGIN_NAMESPACE
 
@@ -47,67 +68,153 @@ public:
 
     void deleteTempFiles() const;
 
+protected:
+
+    void closeEvent(QCloseEvent* event) override;
+
 private slots:
 
+    void startBackgroundTasks();
+
     void on_FileSelector_Button_clicked();
 
     void on_Run_Button_clicked();
 
+    void OnQuerySent(QNetworkReply* reply, const QString& symbol)
+    {
+        // Parse chunks as they arrive so parsing overlaps the download
+        const int streamId = pipeline.beginStream(symbol);
+        reply->setProperty("streamId", streamId);
+        reply->setProperty("symbol", symbol);
+
+        connect(reply, &QNetworkReply::readyRead, this, [this, reply, streamId]()
+        {
+            if (reply->error() == QNetworkReply::NoError)
+                pipeline.feedStream(streamId, reply->readAll());
+        });
+    }
+
     void OnDataReceived(QNetworkReply* reply)
     {
+        // Bulk quote replies are consumed by the fetcher itself
+        if (reply->property("batch").toBool())
+            return;
+
+        const int streamId = reply->property("streamId").toInt();
+
         if (reply->error() != QNetworkReply::NoError)
         {
             qDebug() << "Failed to fetch stock data: " << reply->errorString();
+            pipeline.abortStream(streamId);
+            refreshScheduler.refreshFinished(reply->property("symbol").toString(), false);
             reply->deleteLater();
+            dataFetcher.release();
             return;
         }
 
-        QByteArray response = reply->readAll();
+        // Whatever arrived after the last readyRead, then hand the series on
+        pipeline.feedStream(streamId, reply->readAll());
+        pipeline.endStream(streamId);
         reply->deleteLater();
+    }
 
-        // Parse the data and get labels
-        sv::StockDataResult result = parseStockData(response);
+    void OnSeriesReady(const sv::PipelineResult& result)
+    {
+        dataFetcher.release();
+        refreshScheduler.refreshFinished(result.symbol, true);
 
-        if (result.points.isEmpty())
+        if (result.unchanged)
         {
-            qDebug() << "No valid stock data!";
+            // Memory already matches the store, unless a provisional quote extended it;
+            // the official bars replace that
+            if (!seriesManager.isPinned(result.symbol))
+                return;
+
+            const sv::SeriesPtr series =
+                sv::SeriesPtr::create(sv::Series::merge(*seriesManager.peek(result.symbol), *result.data.series));
+            seriesManager.insert(series);
+            discardDataFile(result.symbol);
+            sv::IndicatorSnapshot& indicators = quoteIndicators[result.symbol];
+            indicators.update(*series);
+            publishSeries(series, indicators.values());
             return;
         }
 
-        // Update the chart with both data points and labels
-        ui->StockView_Chart->setData(result.points, result.labels);
+        seriesManager.insert(result.data.series);
+        discardDataFile(result.symbol);
+        publishSeries(result.data.series, result.indicators);
+    }
 
-        // Create temporary file
-        QTemporaryFile tempFile;
-        tempFile.setAutoRemove(false); // Don't delete automatically
+    void OnQuoteReceived(const QString& symbol, const sv::Bar& bar)
+    {
+        refreshScheduler.refreshFinished(symbol, true);
 
-        if (!tempFile.open())
-        {
-            qDebug() << "Failed to create temporary file";
+        const sv::SeriesPtr cached = seriesManager.get(symbol);
+        if (cached.isNull())
             return;
-        }
 
-        // Write data to file in CSV format
-        QTextStream stream(&tempFile);
-        stream << "timestamp,price\n"; // Header
+        // The quote replaces or extends the latest daily bar. It is provisional,
+        // so it stays pinned in memory; the store gets the official bar after the close
+        if (!cached->isEmpty() && bar.time < cached->lastTime())
+            return;
+        sv::Series updated = *cached;
+        if (!updated.isEmpty() && bar.time == updated.lastTime())
+            updated.replaceLast(bar);
+        else
+            updated.append(bar);
+
+        const sv::SeriesPtr series = sv::SeriesPtr::create(std::move(updated));
+        seriesManager.insert(series, false);
+        discardDataFile(symbol);
+
+        // Kept per symbol, so a quote revises the latest bar in O(1) instead of replaying the history
+        sv::IndicatorSnapshot& indicators = quoteIndicators[symbol];
+        indicators.update(*series);
+        publishSeries(series, indicators.values());
+    }
 
-        for (const QPointF& point : result.points)
-        {
-            stream << QString::number(point.x()) << ","
-                   << QString::number(point.y()) << "\n";
-        }
+    void OnSeriesFailed(const QString& symbol, const QString& error)
+    {
+        dataFetcher.release();
+        refreshScheduler.refreshFinished(symbol, false);
+        qDebug() << symbol << error;
+    }
 
-        tempFilePath = tempFile.fileName();
-        tempFile.close();
+    void on_GraphStocks_Button_clicked();
 
-        // Update the chart
-        ui->StockView_Chart->setData(result.points, result.labels);
+    void on_Reload_Button_clicked();
 
-        ui->DataFile_LineEdit->setText( "Current Data File: " + tempFilePath );
-//        QFile::remove(tempFilePath);
-    }
+    void on_Analysis_ComboBox_activated(int index);
 
-    void on_GraphStocks_Button_clicked();
+    void on_actionBacktest_triggered();
+
+    void on_actionParameterSweep_triggered();
+
+    void on_actionCorrelation_triggered();
+
+    void on_actionDashboard_triggered();
+
+    void on_actionMemoryUsage_triggered();
+
+    void on_actionImportDirectory_triggered();
+
+    void on_actionAlertRules_triggered();
+
+    void on_actionReplayStart_triggered();
+
+    void on_actionReplayPause_triggered();
+
+    void on_actionReplayStep_triggered();
+
+    void on_actionReplaySeek_triggered();
+
+    void on_actionReplayStop_triggered();
+
+    void on_AddToWatchlist_Button_clicked();
+
+    void on_RemoveFromWatchlist_Button_clicked();
+
+    void on_Watchlist_ListWidget_currentTextChanged(const QString& symbol);
 
 private:
 
@@ -115,102 +222,91 @@ private:
     QGraphicsScene* scene;
     QString tempFilePath;
     DataFetcher dataFetcher;
+    sv::SeriesStore store;
+    sv::SeriesPipeline pipeline;
+    // Background jobs that use the window or its store; the destructor sets
+    // `closing` and waits for them
+    QThreadPool taskPool;
+    std::atomic<bool> closing{ false };
+    PluginHost pluginHost;
+    Watchlist watchlist;
+    RefreshScheduler refreshScheduler;
+    QString displayedSymbol;
+    sv::SeriesPtr currentSeries;
+    sv::SeriesManager seriesManager;
+    QMap<QString, QString> dataFiles;
+    sv::CorrelationEngine correlationEngine;
+    int correlationWindow = 0;
+    bool correlationCommitPending = false;
+    QPointer<HeatmapWidget> heatmap;
+    QPointer<DashboardWidget> dashboard;
+    sv::AlertEngine alertEngine;
+    QStringList alertRules;
+    sv::AnalysisResult lastAnalysis;
+    sv::AnalysisCache analysisCache;
+    ReplayEngine replayEngine;
+    sv::IndicatorSnapshot replayIndicators;
+    QHash<QString, sv::IndicatorSnapshot> quoteIndicators;
+    QHash<QString, sv::OuForecaster> forecasters;
+    sv::OuForecaster replayForecaster;
 
-    void fetchStockData(const QString &symbol)
-    {
-       dataFetcher.MakeQuery(symbol);
-    }
+    void refreshAnalysisList();
 
-    sv::StockDataResult parseStockData(const QByteArray& jsonData)
-    {
-        sv::StockDataResult result;
-        QJsonDocument doc = QJsonDocument::fromJson(jsonData);
+    // Put the displayed symbol's forecast band on the chart, or clear it if disabled
+    void showForecast();
 
-        if (!doc.isObject())
-        {
-            qDebug() << "Invalid JSON format";
-            return result;
-        }
+    // Print the displayed symbol's fitted forecast parameters to the console
+    void reportForecast();
 
-        QJsonObject root = doc.object();
+    // Watchlist symbols, or the graphed tickers if the watchlist is empty
+    QStringList dashboardSymbols() const;
 
-        // Get the metadata
-        QJsonObject metadata = root["Meta Data"].toObject();
-        QString symbol = metadata["2. Symbol"].toString();
+    // Bring an open dashboard in line with dashboardSymbols() without showing or raising it
+    void refreshDashboardSymbols();
 
-        // The time series data is under "Time Series (Daily)"
-        QJsonObject timeSeriesData = root["Time Series (Daily)"].toObject();
+    // False, with a status message, if a script run would block on the venv being provisioned
+    bool canRunNow(const QString& scriptPath);
 
-        // Convert dates to timestamps and extract prices
-        for (auto it = timeSeriesData.begin(); it != timeSeriesData.end(); ++it)
-        {
-            QString dateStr = it.key();
-            QJsonObject dayData = it.value().toObject();
+    // Run a script or plugin on `series` without consulting the analysis cache
+    sv::AnalysisResult runAnalysis(const QString& scriptPath, const sv::SeriesPtr& series,
+                                   const QStringList& tickerSymbols, const QStringList& extraArguments);
 
-            // Convert date to timestamp
-            QDateTime dateTime = QDateTime::fromString(dateStr, "yyyy-MM-dd");
-            double timestamp = dateTime.toSecsSinceEpoch();
+    void showAnalysisResult(const sv::AnalysisResult& result);
 
-            // Get the closing price
-            double price = dayData["4. close"].toString().toDouble();
+    void restoreSession();
 
-            result.points.append(QPointF(timestamp, price));
-        }
+    void saveSession() const;
 
-        // Sort points by timestamp
-        std::sort(result.points.begin(), result.points.end(),
-                  [](const QPointF& a, const QPointF& b) { return a.x() < b.x(); });
+    // Compile "SYMBOL: expression" lines (or a bare expression for every symbol)
+    void setAlertRules(const QStringList& rules);
 
-        // Set up the labels map
-        result.labels = {
-            {"x_axis", "Date"},
-            {"y_axis", "Price (USD)"},
-            {"legend", symbol + " Stock Price"},
-            {"title", symbol + " Daily Stock Prices"}
-        };
+    // Replayed alerts go to the console and status bar but not to alerts.log
+    void reportAlerts(const QVector<sv::AlertHit>& hits, bool replayed = false);
 
-        return result;
-    }
+    // Rebuild the chart, alert and indicator state from the bars a replay has delivered so far
+    void onReplayRewound(const sv::SeriesPtr& history, int position);
 
-    sv::StockDataResult readStockData(const QString& filename, const QString& symbol)
-    {
-        sv::StockDataResult result;
-        result.labels = {
-            {"x_axis", "Date"},
-            {"y_axis", "Price (USD)"},
-            {"legend", "est. " + symbol + " Stock Price"},
-            {"title", symbol + " Daily Stock Prices"}
-        };
-
-        QFile file(filename);
-
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-            return result;
-
-        QTextStream in(&file);
-
-        // Skip header line
-        QString header = in.readLine();
-
-        // Read data lines
-        while (!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList fields = line.split(',');
-
-            if (fields.size() >= 2) {
-                bool okTime, okPrice;
-                double timestamp = fields[0].toDouble(&okTime);
-                double price = fields[1].toDouble(&okPrice);
-
-                if (okTime && okPrice) {
-                    result.points.append(QPointF(timestamp, price));
-                }
-            }
-        }
+    // The live update path, fed by the replay instead of the network
+    void onReplayBars(const QString& symbol, const QVector<sv::Bar>& bars);
 
-        file.close();
-        return result;
-    }
+    void fetchStockData(const QString& symbol);
+
+    // Show the symbol from memory or the on-disk cache; false if neither has it
+    bool showSymbol(const QString& symbol);
+
+    void displaySeries(const sv::SeriesPtr& series);
+
+    // Bring the engine up to date with `series` and show the heatmap
+    void showCorrelation(const QVector<sv::SeriesPtr>& series, int window);
+
+    // Redraw an open heatmap from the engine without raising it
+    void refreshHeatmap();
+
+    // Delete the symbol's script data file once its series is superseded; runAnalysis writes a new one when needed
+    void discardDataFile(const QString& symbol);
+
+    // Hand a new version of a series to alerts, the dashboard and, if on screen, the chart
+    void publishSeries(const sv::SeriesPtr& series, const QMap<QString, double>& indicators);
 
    void graphEstimate(const QString& estimatePath)
     {
@@ -0,0 +1,78 @@
+#ifndef STOCKVIEWPLUGIN_H
+#define STOCKVIEWPLUGIN_H
+
+/*
+ * StockView native analytics plugin interface.
+ *
+ * A plugin is a shared library (.dll/.so/.dylib) exporting the two functions
+ * declared at the bottom of this file. The host loads it with QLibrary, hands
+ * it a read-only columnar view of the current series and collects whatever the
+ * plugin emits through the sv_host callbacks. Only plain C types cross this
+ * boundary, so plugins may be built with any compiler; they must not let C++
+ * exceptions escape sv_plugin_run.
+ */
+
+#include <stddef.h>
+
+#define SV_PLUGIN_API_VERSION 1
+
+#if defined(_WIN32)
+#define SV_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define SV_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Read-only view of one symbol's history; all columns have `length` entries
+ * and are sorted by ascending time (UNIX seconds). The memory is owned by the
+ * host and is only valid for the duration of sv_plugin_run. */
+typedef struct sv_series_view
+{
+    const char* symbol;
+    size_t length;
+    const double* time;
+    const double* open;
+    const double* high;
+    const double* low;
+    const double* close;
+    const double* volume;
+} sv_series_view;
+
+/* Callbacks into the host. Every pointer argument is copied before the
+ * callback returns, so plugins may pass stack buffers. */
+typedef struct sv_host
+{
+    void* context;
+    void (*emit_series)(void* context, const char* name, const double* time, const double* values, size_t length);
+    void (*emit_metric)(void* context, const char* name, double value);
+    void (*emit_annotation)(void* context, double time, const char* text);
+    void (*print)(void* context, const char* text);
+} sv_host;
+
+typedef struct sv_plugin_info
+{
+    int api_version;
+    const char* name;
+    const char* description;
+} sv_plugin_info;
+
+typedef const sv_plugin_info* (*sv_plugin_get_info_fn)(void);
+typedef int (*sv_plugin_run_fn)(const sv_series_view* series, int argc, const char* const* argv, const sv_host* host);
+
+/* Exported by every plugin:
+ *
+ *   SV_PLUGIN_EXPORT const sv_plugin_info* sv_plugin_get_info(void);
+ *   SV_PLUGIN_EXPORT int sv_plugin_run(const sv_series_view* series, int argc,
+ *                                      const char* const* argv, const sv_host* host);
+ *
+ * sv_plugin_run returns 0 on success; any other value is reported like a
+ * non-zero Python exit code. */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STOCKVIEWPLUGIN_H */
@@ -0,0 +1,138 @@
+// Native port of python/SimpleAnalysis.py built as a StockView plugin.
+// Emits the 20/50 day moving averages as series, the summary statistics as
+// metrics and marks SMA crossovers as annotations.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "StockViewPlugin.h"
+
+namespace
+{
+
+const sv_plugin_info pluginInfo = {
+    SV_PLUGIN_API_VERSION,
+    "Simple Analysis (native)",
+    "Moving averages, volatility and RSI computed in-process"
+};
+
+std::vector<double> rollingMean(const double* values, size_t length, size_t window)
+{
+    std::vector<double> result(length, NAN);
+    double sum = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        sum += values[i];
+        if (i >= window)
+            sum -= values[i - window];
+        if (i + 1 >= window)
+            result[i] = sum / window;
+    }
+    return result;
+}
+
+void emitDefined(const sv_host* host, const char* name, const double* time, const std::vector<double>& values)
+{
+    size_t first = 0;
+    while (first < values.size() && std::isnan(values[first]))
+        ++first;
+    if (first < values.size())
+        host->emit_series(host->context, name, time + first, values.data() + first, values.size() - first);
+}
+
+}
+
+extern "C" SV_PLUGIN_EXPORT const sv_plugin_info* sv_plugin_get_info(void)
+{
+    return &pluginInfo;
+}
+
+extern "C" SV_PLUGIN_EXPORT int sv_plugin_run(const sv_series_view* series, int argc, const char* const* argv,
+                                              const sv_host* host)
+{
+    (void)argc;
+    (void)argv;
+
+    const size_t n = series->length;
+    if (n < 2)
+    {
+        host->print(host->context, "Not enough data for analysis\n");
+        return 1;
+    }
+
+    const double* close = series->close;
+
+    double mean = 0;
+    for (size_t i = 0; i < n; ++i)
+        mean += close[i];
+    mean /= n;
+
+    double variance = 0;
+    for (size_t i = 0; i < n; ++i)
+        variance += (close[i] - mean) * (close[i] - mean);
+    const double stdPrice = std::sqrt(variance / (n - 1));
+
+    // Daily returns, volatility and the 14 day RSI over returns as in the script
+    std::vector<double> returns(n - 1);
+    double returnMean = 0;
+    for (size_t i = 1; i < n; ++i)
+    {
+        returns[i - 1] = close[i] / close[i - 1] - 1;
+        returnMean += returns[i - 1];
+    }
+    returnMean /= returns.size();
+
+    double returnVariance = 0;
+    for (double r : returns)
+        returnVariance += (r - returnMean) * (r - returnMean);
+    const double volatility = returns.size() > 1 ? std::sqrt(returnVariance / (returns.size() - 1)) * std::sqrt(252.0) : 0;
+
+    double rsi = NAN;
+    const size_t rsiWindow = 14;
+    if (returns.size() >= rsiWindow)
+    {
+        double gain = 0, loss = 0;
+        for (size_t i = returns.size() - rsiWindow; i < returns.size(); ++i)
+        {
+            if (returns[i] > 0)
+                gain += returns[i];
+            else
+                loss -= returns[i];
+        }
+        rsi = loss == 0 ? 100 : 100 - 100 / (1 + gain / loss);
+    }
+
+    const std::vector<double> sma20 = rollingMean(close, n, 20);
+    const std::vector<double> sma50 = rollingMean(close, n, 50);
+
+    emitDefined(host, "SMA 20", series->time, sma20);
+    emitDefined(host, "SMA 50", series->time, sma50);
+
+    for (size_t i = 1; i < n; ++i)
+    {
+        if (std::isnan(sma50[i - 1]))
+            continue;
+        const bool wasAbove = sma20[i - 1] > sma50[i - 1];
+        const bool isAbove = sma20[i] > sma50[i];
+        if (wasAbove != isAbove)
+            host->emit_annotation(host->context, series->time[i], isAbove ? "Golden cross" : "Death cross");
+    }
+
+    host->emit_metric(host->context, "Latest Price", close[n - 1]);
+    host->emit_metric(host->context, "Average Price", mean);
+    host->emit_metric(host->context, "Standard Deviation", stdPrice);
+    host->emit_metric(host->context, "Volatility (Annualized)", volatility);
+    if (!std::isnan(rsi))
+        host->emit_metric(host->context, "RSI (14-day)", rsi);
+
+    const bool upward = !std::isnan(sma50[n - 1]) && sma20[n - 1] > sma50[n - 1];
+
+    char summary[256];
+    std::snprintf(summary, sizeof(summary),
+                  "Stock Analysis for %s:\n------------------------\nCurrent Trend: %s\nTrend Signal: %s\n",
+                  series->symbol, upward ? "UPWARD" : "DOWNWARD", upward ? "BULLISH" : "BEARISH");
+    host->print(host->context, summary);
+
+    return 0;
+}
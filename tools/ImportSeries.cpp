@@ -0,0 +1,50 @@
+// Imports a directory of per-symbol CSV files into the series store and
+// reports throughput.
+//
+//   ImportSeries ~/data/daily
+//   ImportSeries ~/data/daily --store /tmp/series --threads 8 --replace
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+
+#include "SeriesImporter.hpp"
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+    // Same cache location as the application's store
+    QCoreApplication::setApplicationName("StockView");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Bulk import per-symbol CSV files into the series store");
+    parser.addHelpOption();
+    parser.addPositionalArgument("directory", "Directory of SYMBOL.csv files.");
+    parser.addOptions({
+        { "store", "Store directory (default: the application's cache).", "path", sv::SeriesStore::defaultDirectory() },
+        { "threads", "Worker threads; 0 uses every core.", "count", "0" },
+        { "replace", "Overwrite stored series instead of keeping their bars outside the imported range." },
+    });
+    parser.process(application);
+
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    const sv::SeriesStore store(parser.value("store"));
+    sv::SeriesImporter importer(&store);
+    importer.setThreadCount(parser.value("threads").toInt());
+    importer.setMergeExisting(!parser.isSet("replace"));
+
+    const sv::ImportReport report = importer.importDirectory(parser.positionalArguments().first());
+    for (const QString& error : report.errors)
+        qWarning().noquote() << error;
+
+    qInfo().noquote() << QString("%1 of %2 files imported, %3 failed (%4 unsupported)")
+        .arg(report.imported).arg(report.files).arg(report.failed).arg(report.unsupported);
+    qInfo().noquote() << QString("%1 rows (%2 rejected), %3 MB in %4 s: %5 rows/s, %6 MB/s")
+        .arg(report.rows).arg(report.rejectedRows)
+        .arg(report.bytes / 1048576.0, 0, 'f', 1).arg(report.seconds, 0, 'f', 2)
+        .arg(report.rowsPerSecond(), 0, 'f', 0).arg(report.megabytesPerSecond(), 0, 'f', 1);
+
+    return report.failed > report.unsupported ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+// Drives the real fetch path (DataFetcher -> streaming SeriesPipeline) against
+// a server, normally MockMarketServer, and reports throughput and latency.
+//
+//   LoadDriver --url http://127.0.0.1:8765 --symbols 500 --concurrency 8
+//   LoadDriver --symbols 500 --quotes          (bulk quote refresh)
+
+#include <algorithm>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTimer>
+
+#include "DataFetcher.hpp"
+#include "SeriesPipeline.hpp"
+
+namespace
+{
+
+double percentile(QVector<double> values, double fraction)
+{
+    if (values.isEmpty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    const int index = std::min(values.size() - 1, static_cast<int>(fraction * values.size()));
+    return values[index];
+}
+
+QString describe(const QString& name, const QVector<double>& milliseconds)
+{
+    return QString("%1 latency ms: p50 %2  p90 %3  p99 %4  max %5").arg(name)
+        .arg(percentile(milliseconds, 0.50), 0, 'f', 1)
+        .arg(percentile(milliseconds, 0.90), 0, 'f', 1)
+        .arg(percentile(milliseconds, 0.99), 0, 'f', 1)
+        .arg(percentile(milliseconds, 1.00), 0, 'f', 1);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+    QCoreApplication::setApplicationName("LoadDriver");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measure end-to-end fetch throughput and latency");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "url", "Server base URL.", "url", "http://127.0.0.1:8765" },
+        { "function", "API function to request.", "name", "TIME_SERIES_DAILY" },
+        { "apikey", "API key sent with each request.", "key", "mock" },
+        { "symbols", "Number of distinct tickers to fetch.", "count", "200" },
+        { "concurrency", "Requests in flight at once (DataFetcher::setMaxInFlight).", "count", "8" },
+        { "compact", "Request only the latest bars (outputsize=compact)." },
+        { "quotes", "Refresh latest quotes through the bulk endpoint instead of fetching series." },
+        { "bulk-function", "Bulk quote API function.", "name", "REALTIME_BULK_QUOTES" },
+        { "timeout", "Give up after this many seconds.", "seconds", "300" },
+    });
+    parser.process(application);
+
+    const int symbolCount = std::max(1, parser.value("symbols").toInt());
+    const bool compact = parser.isSet("compact");
+    const bool quotes = parser.isSet("quotes");
+
+    DataFetcher dataFetcher;
+    dataFetcher.setEndpoint(parser.value("url"), parser.value("function"), parser.value("apikey"));
+    dataFetcher.setMaxInFlight(parser.value("concurrency").toInt());
+    dataFetcher.setBulkEndpoint(parser.value("bulk-function"), 100);
+
+    QNetworkAccessManager networkManager;
+    dataFetcher.setNetworkManager(&networkManager);
+
+    sv::SeriesPipeline pipeline;
+
+    QElapsedTimer clock;
+    QHash<QString, qint64> queuedAt;
+    QHash<QString, qint64> sentAt;
+    QVector<double> endToEnd;
+    QVector<double> request;
+    qint64 bars = 0;
+    int requests = 0;
+    int succeeded = 0;
+    int failed = 0;
+
+    auto finishOne = [&](const QString& symbol, bool success)
+    {
+        const qint64 now = clock.nsecsElapsed();
+        if (success)
+        {
+            ++succeeded;
+            endToEnd.append((now - queuedAt.value(symbol)) / 1e6);
+            if (sentAt.contains(symbol))
+                request.append((now - sentAt.value(symbol)) / 1e6);
+        }
+        else
+        {
+            ++failed;
+        }
+
+        if (succeeded + failed == symbolCount)
+            application.quit();
+    };
+
+    // The same streaming wiring the window uses
+    QObject::connect(&dataFetcher, &DataFetcher::querySent, [&](QNetworkReply* reply, const QString& symbol)
+    {
+        sentAt.insert(symbol, clock.nsecsElapsed());
+        const int streamId = pipeline.beginStream(symbol);
+        reply->setProperty("streamId", streamId);
+        reply->setProperty("symbol", symbol);
+
+        QObject::connect(reply, &QNetworkReply::readyRead, [&pipeline, reply, streamId]()
+        {
+            if (reply->error() == QNetworkReply::NoError)
+                pipeline.feedStream(streamId, reply->readAll());
+        });
+    });
+
+    QObject::connect(&networkManager, &QNetworkAccessManager::finished, [&](QNetworkReply* reply)
+    {
+        ++requests;
+        if (reply->property("batch").toBool())
+            return;
+
+        const int streamId = reply->property("streamId").toInt();
+        if (reply->error() != QNetworkReply::NoError)
+        {
+            pipeline.abortStream(streamId);
+            dataFetcher.release();
+            finishOne(reply->property("symbol").toString(), false);
+        }
+        else
+        {
+            pipeline.feedStream(streamId, reply->readAll());
+            pipeline.endStream(streamId);
+        }
+        reply->deleteLater();
+    });
+
+    QObject::connect(&pipeline, &sv::SeriesPipeline::seriesReady, [&](const sv::PipelineResult& result)
+    {
+        dataFetcher.release();
+        bars += result.data.series.isNull() ? 0 : result.data.series->size();
+        QFile::remove(result.dataFile);
+        finishOne(result.symbol, true);
+    });
+
+    QObject::connect(&pipeline, &sv::SeriesPipeline::failed, [&](const QString& symbol, const QString& error)
+    {
+        dataFetcher.release();
+        qWarning().noquote() << symbol << error;
+        finishOne(symbol, false);
+    });
+
+    QObject::connect(&dataFetcher, &DataFetcher::quoteReceived, [&](const QString& symbol, const sv::Bar&)
+    {
+        ++bars;
+        finishOne(symbol, true);
+    });
+
+    QObject::connect(&dataFetcher, &DataFetcher::queryFailed, [&](const QString& symbol, const QString&)
+    {
+        finishOne(symbol, false);
+    });
+
+    QTimer::singleShot(parser.value("timeout").toInt() * 1000, &application, [&]()
+    {
+        qWarning() << "Timed out with" << symbolCount - succeeded - failed << "tickers outstanding";
+        application.exit(2);
+    });
+
+    clock.start();
+    for (int i = 0; i < symbolCount; ++i)
+    {
+        const QString symbol = QString("SYM%1").arg(i, 4, 10, QChar('0'));
+        queuedAt.insert(symbol, clock.nsecsElapsed());
+        if (quotes)
+            dataFetcher.requestQuote(symbol);
+        else
+            dataFetcher.MakeQuery(symbol, compact);
+    }
+
+    const int status = application.exec();
+    const double seconds = clock.nsecsElapsed() / 1e9;
+
+    qInfo().noquote() << QString("%1 tickers (%2 ok, %3 failed) in %4 requests, %5 s: %6 tickers/s, %7 bars/s")
+                         .arg(symbolCount).arg(succeeded).arg(failed).arg(requests)
+                         .arg(seconds, 0, 'f', 2)
+                         .arg(succeeded / seconds, 0, 'f', 1)
+                         .arg(bars / seconds, 0, 'f', 0);
+    qInfo().noquote() << describe("End-to-end", endToEnd);
+    qInfo().noquote() << describe("Request", request);
+    return status;
+}
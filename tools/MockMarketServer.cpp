@@ -0,0 +1,353 @@
+// Local stand-in for the market-data API, for offline and reproducible
+// performance testing. Speaks the /query?function=...&symbol=...&apikey=...
+// protocol QueryBuilder produces and answers with deterministic synthetic
+// daily histories in the same JSON layout as the real service, and with
+// REALTIME_BULK_QUOTES for up to 100 comma-separated symbols.
+//
+//   MockMarketServer --port 8765 --bars 5000 --latency 50 --jitter 20
+//                    --error-rate 0.01 --rate-limit 300 --seed 1
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QDebug>
+#include <QHash>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+
+namespace
+{
+
+struct ServerConfig
+{
+    int bars = 5000;
+    int compactBars = 100;
+    int latency = 0;                 // milliseconds before each response
+    int jitter = 0;                  // uniform extra latency in [0, jitter]
+    double errorRate = 0;            // fraction of requests answered with an error
+    int rateLimit = 0;               // requests per minute per API key; 0 disables
+    quint32 seed = 1;
+};
+
+// FNV-1a, so every run derives the same history from a symbol
+quint64 symbolSeed(const QString& symbol, quint32 seed)
+{
+    quint64 hash = 1469598103934665603ull ^ seed;
+    for (const char c : symbol.toUpper().toUtf8())
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// The last `count` weekdays up to and including `end`, oldest first
+QVector<QDate> tradingDays(const QDate& end, int count)
+{
+    QVector<QDate> days;
+    days.reserve(count);
+    for (QDate day = end; days.size() < count; day = day.addDays(-1))
+    {
+        if (day.dayOfWeek() <= 5)
+            days.append(day);
+    }
+    std::reverse(days.begin(), days.end());
+    return days;
+}
+
+struct History
+{
+    QVector<QDate> days;
+    QVector<double> open, high, low, close, volume;
+};
+
+History simulate(const QString& symbol, int bars, quint32 seed)
+{
+    // A geometric random walk; the full history is always simulated so the
+    // compact view and the latest quote agree with the full series
+    std::mt19937_64 random(symbolSeed(symbol, seed));
+    std::normal_distribution<double> returns(0.0003, 0.015);
+    std::uniform_real_distribution<double> range(0.0, 0.01);
+    std::lognormal_distribution<double> volumes(14, 0.5);
+
+    History history;
+    history.days = tradingDays(QDate(2024, 12, 31), bars);
+    history.open.resize(bars);
+    history.high.resize(bars);
+    history.low.resize(bars);
+    history.close.resize(bars);
+    history.volume.resize(bars);
+    double last = 20 + static_cast<double>(random() % 18000) / 100;
+
+    for (int i = 0; i < bars; ++i)
+    {
+        history.open[i] = last;
+        history.close[i] = last = std::max(0.01, history.open[i] * std::exp(returns(random)));
+        history.high[i] = std::max(history.open[i], history.close[i]) * (1 + range(random));
+        history.low[i] = std::min(history.open[i], history.close[i]) * (1 - range(random));
+        history.volume[i] = std::floor(volumes(random));
+    }
+    return history;
+}
+
+QByteArray dailySeries(const QString& symbol, int bars, int outputBars, quint32 seed)
+{
+    // Only the returned bars are formatted
+    const History history = simulate(symbol, bars, seed);
+
+    // Newest first, as the real API sends it
+    QByteArray body = QString("{\n"
+                              "    \"Meta Data\": {\n"
+                              "        \"1. Information\": \"Daily Prices (open, high, low, close) and Volumes\",\n"
+                              "        \"2. Symbol\": \"%1\",\n"
+                              "        \"3. Last Refreshed\": \"%2\",\n"
+                              "        \"4. Output Size\": \"%3\",\n"
+                              "        \"5. Time Zone\": \"US/Eastern\"\n"
+                              "    },\n"
+                              "    \"Time Series (Daily)\": {\n")
+        .arg(symbol.toUpper(), history.days.last().toString("yyyy-MM-dd"), outputBars < bars ? "Compact" : "Full size")
+        .toUtf8();
+
+    for (int i = bars - 1; i >= bars - outputBars; --i)
+    {
+        body += QString("        \"%1\": {\n"
+                          "            \"1. open\": \"%2\",\n"
+                          "            \"2. high\": \"%3\",\n"
+                          "            \"3. low\": \"%4\",\n"
+                          "            \"4. close\": \"%5\",\n"
+                          "            \"5. volume\": \"%6\"\n"
+                          "        }")
+            .arg(history.days[i].toString("yyyy-MM-dd"))
+            .arg(history.open[i], 0, 'f', 4).arg(history.high[i], 0, 'f', 4)
+            .arg(history.low[i], 0, 'f', 4).arg(history.close[i], 0, 'f', 4)
+            .arg(static_cast<qint64>(history.volume[i])).toUtf8();
+        body += i > bars - outputBars ? ",\n" : "\n";
+    }
+    body += "    }\n}";
+    return body;
+}
+
+// The latest bar of every symbol, in the bulk quote layout
+QByteArray bulkQuotes(const QStringList& symbols, int bars, quint32 seed)
+{
+    QByteArray body = "{\n    \"endpoint\": \"Realtime Bulk Quotes\",\n    \"data\": [\n";
+    for (int s = 0; s < symbols.size(); ++s)
+    {
+        const History history = simulate(symbols[s], bars, seed);
+        const int i = bars - 1;
+        body += QString("        {\"symbol\": \"%1\", \"timestamp\": \"%2 16:00:00.000\", \"open\": \"%3\", "
+                        "\"high\": \"%4\", \"low\": \"%5\", \"close\": \"%6\", \"volume\": \"%7\"}")
+            .arg(symbols[s].toUpper(), history.days[i].toString("yyyy-MM-dd"))
+            .arg(history.open[i], 0, 'f', 4).arg(history.high[i], 0, 'f', 4)
+            .arg(history.low[i], 0, 'f', 4).arg(history.close[i], 0, 'f', 4)
+            .arg(static_cast<qint64>(history.volume[i])).toUtf8();
+        body += s + 1 < symbols.size() ? ",\n" : "\n";
+    }
+    body += "    ]\n}";
+    return body;
+}
+
+QByteArray message(const char* key, const QString& text)
+{
+    return QString("{\n    \"%1\": \"%2\"\n}").arg(key, text).toUtf8();
+}
+
+class MockMarketServer : public QObject
+{
+public:
+    explicit MockMarketServer(const ServerConfig& config, QObject* parent = nullptr)
+        : QObject(parent), config(config), random(config.seed)
+    {
+        connect(&server, &QTcpServer::newConnection, this, [this]()
+        {
+            while (QTcpSocket* socket = server.nextPendingConnection())
+            {
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+                connect(socket, &QTcpSocket::disconnected, this, [this, socket]()
+                {
+                    buffers.remove(socket);
+                    socket->deleteLater();
+                });
+            }
+        });
+    }
+
+    bool listen(quint16 port)
+    {
+        return server.listen(QHostAddress::LocalHost, port);
+    }
+
+    quint16 port() const
+    {
+        return server.serverPort();
+    }
+
+private:
+    struct Response
+    {
+        int status;
+        QByteArray body;
+    };
+
+    // Requests on a keep-alive connection may arrive back to back in one read
+    void onReadyRead(QTcpSocket* socket)
+    {
+        QByteArray& buffer = buffers[socket];
+        buffer += socket->readAll();
+
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) >= 0)
+        {
+            const QByteArray head = buffer.left(end);
+            buffer.remove(0, end + 4);
+
+            const QList<QByteArray> lines = head.split('\n');
+            const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+            const bool close = head.toLower().contains("connection: close");
+
+            const Response response = requestLine.value(0) == "GET"
+                ? respond(QUrl::fromEncoded(requestLine.value(1)))
+                : Response{ 405, message("Error Message", "Only GET is supported") };
+
+            send(socket, response, close);
+        }
+    }
+
+    Response respond(const QUrl& url)
+    {
+        if (url.path() != "/query")
+            return { 404, message("Error Message", "Unknown endpoint " + url.path()) };
+
+        const QUrlQuery query(url);
+        const QString function = query.queryItemValue("function");
+        const QString symbol = query.queryItemValue("symbol");
+        const QString apiKey = query.queryItemValue("apikey");
+
+        const bool bulk = function == "REALTIME_BULK_QUOTES";
+        if ((!bulk && !function.startsWith("TIME_SERIES_DAILY")) || symbol.isEmpty())
+        {
+            return { 200, message("Error Message", "Invalid API call. Please retry or visit the documentation "
+                                                   "for " + function + ".") };
+        }
+
+        if (isRateLimited(apiKey))
+        {
+            return { 200, message("Note", QString("Thank you for using the mock API. The standard call "
+                                                  "frequency is %1 calls per minute.").arg(config.rateLimit)) };
+        }
+
+        if (std::uniform_real_distribution<double>(0, 1)(random) < config.errorRate)
+            return { 500, message("Error Message", "Injected failure") };
+
+        if (bulk)
+            return { 200, bulkQuotes(symbol.split(',', Qt::SkipEmptyParts).mid(0, 100), config.bars, config.seed) };
+
+        const bool compact = query.queryItemValue("outputsize") != "full";
+        const int bars = config.bars;
+        return { 200, dailySeries(symbol, bars, compact ? std::min(config.compactBars, bars) : bars, config.seed) };
+    }
+
+    // Sliding one-minute window per API key
+    bool isRateLimited(const QString& apiKey)
+    {
+        if (config.rateLimit <= 0)
+            return false;
+
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        QVector<qint64>& calls = callTimes[apiKey];
+        calls.erase(std::remove_if(calls.begin(), calls.end(), [now](qint64 t) { return now - t >= 60000; }),
+                    calls.end());
+
+        if (calls.size() >= config.rateLimit)
+            return true;
+        calls.append(now);
+        return false;
+    }
+
+    void send(QTcpSocket* socket, const Response& response, bool close)
+    {
+        const int delay = config.latency
+            + (config.jitter > 0 ? std::uniform_int_distribution<int>(0, config.jitter)(random) : 0);
+
+        QByteArray reply = QString("HTTP/1.1 %1 %2\r\n"
+                                   "Content-Type: application/json\r\n"
+                                   "Content-Length: %3\r\n"
+                                   "Connection: %4\r\n\r\n")
+            .arg(response.status)
+            .arg(response.status == 200 ? "OK" : "Error")
+            .arg(response.body.size())
+            .arg(close ? "close" : "keep-alive")
+            .toUtf8();
+        reply += response.body;
+
+        // QNetworkAccessManager does not pipeline, so a connection never has two
+        // delayed responses racing each other
+        QPointer<QTcpSocket> target(socket);
+        QTimer::singleShot(delay, this, [this, target, reply, close]()
+        {
+            if (target.isNull())
+                return;
+            target->write(reply);
+            if (close)
+                target->disconnectFromHost();
+        });
+    }
+
+    ServerConfig config;
+    std::mt19937 random;
+    QTcpServer server;
+    QHash<QTcpSocket*, QByteArray> buffers;
+    QHash<QString, QVector<qint64>> callTimes;
+};
+
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+    QCoreApplication::setApplicationName("MockMarketServer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Deterministic stand-in for the StockView market-data API");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "port", "Port to listen on (0 picks a free one).", "port", "8765" },
+        { "bars", "Daily bars in a full history.", "count", "5000" },
+        { "compact-bars", "Bars returned for outputsize=compact.", "count", "100" },
+        { "latency", "Delay before each response.", "ms", "0" },
+        { "jitter", "Additional random delay of up to this much.", "ms", "0" },
+        { "error-rate", "Fraction of requests failing with HTTP 500.", "fraction", "0" },
+        { "rate-limit", "Requests per minute per API key before rate-limit notes; 0 disables.", "count", "0" },
+        { "seed", "Seed for prices, injected errors and jitter.", "seed", "1" },
+    });
+    parser.process(application);
+
+    ServerConfig config;
+    config.bars = std::max(1, parser.value("bars").toInt());
+    config.compactBars = std::max(1, parser.value("compact-bars").toInt());
+    config.latency = std::max(0, parser.value("latency").toInt());
+    config.jitter = std::max(0, parser.value("jitter").toInt());
+    config.errorRate = parser.value("error-rate").toDouble();
+    config.rateLimit = parser.value("rate-limit").toInt();
+    config.seed = parser.value("seed").toUInt();
+
+    MockMarketServer server(config);
+    if (!server.listen(static_cast<quint16>(parser.value("port").toUInt())))
+    {
+        qCritical() << "Could not listen on port" << parser.value("port");
+        return 1;
+    }
+
+    qInfo().noquote() << QString("Serving on http://127.0.0.1:%1 (URL=http://127.0.0.1:%1, FUNCTION=TIME_SERIES_DAILY)")
+                         .arg(server.port());
+    return application.exec();
+}